@@ -0,0 +1,57 @@
+#pragma once
+#include "common.h"
+#include <memory_region.h>
+#include <watchpoints.h>
+#include <fstream>
+#include <string>
+
+enum AccessKind {
+    ACCESS_READ,
+    ACCESS_WRITE,
+    ACCESS_FETCH,       // Instruction bytes: opcode, CB prefix and operands
+    ACCESS_KIND_COUNT
+};
+
+// MBC register windows hit by writes to 0x0000-0x7FFF
+constexpr int BANK_WRITE_KINDS = 4;
+
+// Bus access heatmap: per 256-byte page, per MemoryRegion and per MBC register.
+// record() is on the CPU bus hot path while profiling, so it only bumps flat
+// counters - no allocation, no logging. Output happens in endFrame()/finish().
+class AccessProfiler {
+public:
+    // perFrame: write one CSV block per frame; otherwise one block at finish()
+    AccessProfiler(const std::string& csvPath, bool perFrame);
+
+    void record(WORD address, AccessKind kind) {
+        m_Frame.pages[address >> WATCH_PAGE_SHIFT][kind]++;
+        m_Frame.regions[static_cast<int>(getMemoryRegion(address))][kind]++;
+        if (kind == ACCESS_WRITE && address < 0x8000) {
+            m_Frame.bankWrites[address >> 13]++;
+        }
+    }
+
+    void endFrame();
+    void finish();               // Flushes the session totals
+    std::string summary() const; // Human-readable session report
+    bool isOpen() const { return m_Csv.is_open(); }
+
+private:
+    struct AccessCounts {
+        uint64_t pages[WATCH_PAGE_COUNT][ACCESS_KIND_COUNT];
+        uint64_t regions[MEMORY_REGION_COUNT][ACCESS_KIND_COUNT];
+        uint64_t bankWrites[BANK_WRITE_KINDS];
+
+        void clear();
+        void add(const AccessCounts& other);
+    };
+
+    void writeRows(const std::string& frame, const AccessCounts& counts);
+
+    AccessCounts m_Frame;
+    AccessCounts m_Session;
+    std::ofstream m_Csv;
+    bool m_PerFrame;
+    bool m_Finished;
+    uint64_t m_FrameNumber;
+};
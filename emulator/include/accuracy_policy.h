@@ -0,0 +1,46 @@
+#pragma once
+#include "common.h"
+#include <string>
+
+namespace GB {
+
+// Compile-time timing policies for the CPU core (see GB::CPUCore).
+//
+// Timer, PPU, DMA and serial state is derived from the scheduler clock when
+// it is observed, so the only thing that differs between the two cores is
+// how finely the clock moves while an instruction runs.
+
+// Whole-instruction stepping: every bus access of an instruction sees the
+// clock at the instruction's first cycle; the run loop advances the clock by
+// the instruction's length afterwards. Right for nearly every game.
+struct InstructionStepped {
+    static constexpr bool TICK_PER_ACCESS = false;
+    static constexpr const char* NAME = "fast";
+};
+
+// M-cycle stepping: the clock advances 4 cycles before every bus access and
+// due events run first, so mid-instruction STAT/LY/DIV reads and DMA
+// conflicts land on the right cycle.
+struct MCycleAccurate {
+    static constexpr bool TICK_PER_ACCESS = true;
+    static constexpr const char* NAME = "accurate";
+};
+
+enum class AccuracyMode : BYTE {
+    FAST,                       // InstructionStepped
+    ACCURATE                    // MCycleAccurate
+};
+
+constexpr const char* ACCURACY_CONFIG_FILE = "accuracy.cfg";
+
+// Per-ROM settings files share one format: each non-comment line is
+// "<rom file name or header title> = <value>", and a "default" entry sets the
+// fallback. Returns the ROM's value, else the default, else an empty string.
+std::string romConfigValue(const std::string& configPath, const std::string& romPath, const std::string& romTitle);
+
+// Looks the ROM up in the accuracy config. Each non-comment line is
+// "<rom file name or header title> = fast|accurate"; a "default" entry sets
+// the fallback. A missing file or entry means FAST.
+AccuracyMode accuracyModeForRom(const std::string& configPath, const std::string& romPath, const std::string& romTitle);
+
+} // namespace GB
@@ -0,0 +1,26 @@
+#pragma once
+#include "common.h"
+#include <cstddef>
+
+// Read-only view of a contiguous block of guest memory - the subset of
+// std::span<const BYTE> the emulator needs, since the build is C++17.
+// Views into the machine state stay valid for the machine's lifetime; a
+// state load copies into the same block.
+class ByteSpan {
+public:
+    constexpr ByteSpan() : m_Data(nullptr), m_Size(0) {}
+    constexpr ByteSpan(const BYTE* data, size_t size) : m_Data(data), m_Size(size) {}
+
+    constexpr const BYTE& operator[](size_t index) const { return m_Data[index]; }
+    constexpr const BYTE* data() const { return m_Data; }
+    constexpr size_t size() const { return m_Size; }
+    constexpr bool empty() const { return m_Size == 0; }
+    constexpr const BYTE* begin() const { return m_Data; }
+    constexpr const BYTE* end() const { return m_Data + m_Size; }
+    // Offset and count, like std::span::subspan
+    constexpr ByteSpan subspan(size_t offset, size_t count) const { return ByteSpan(m_Data + offset, count); }
+
+private:
+    const BYTE* m_Data;
+    size_t m_Size;
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include "common.h"  // Add this at the top
+#include "rom_image.h"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -83,8 +85,10 @@ private:
     bool romBankingMode;
     
     // Cartridge memory
-    std::vector<BYTE> m_CartridgeMemory; // Holds the ROM data
-    std::vector<BYTE> m_CartridgeRAM;    // Holds the external RAM data
+    std::shared_ptr<const RomImage> m_Rom; // ROM data, shared with other instances of the same game
+    BYTE* m_CartridgeRAM;                  // External RAM, owned by the machine state block
+    size_t m_CartridgeRAMSize;             // Usable bytes behind m_CartridgeRAM
+    size_t m_HeaderRAMSize;                // External RAM size declared by the header
     bool loaded;
 
     // Cartridge type info
@@ -104,6 +108,10 @@ public:
     
     // Memory access
     BYTE getCartridgeType() const { return cartridgeType; }
+    std::string getTitle() const;  // Header title, without the NUL padding
+    const std::shared_ptr<const RomImage>& getRomImage() const { return m_Rom; }
+    size_t getRAMSize() const { return m_HeaderRAMSize; }
+    void attachRAM(BYTE* ram, size_t size);
     BYTE read(WORD address);
     void write(WORD address, BYTE data);
 
@@ -118,5 +126,5 @@ private:
     bool verifyChecksum() const;
     void saveRAM() const;
     void loadRAM();
-    BYTE calculate_gameboy_header_checksum(const std::vector<unsigned char>& cartridge_memory)const;
+    BYTE calculate_gameboy_header_checksum(const RomImage& cartridge_memory)const;
 };
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+#include "common.h"
+#include <SDL3/SDL.h>
+
+// The four DMG shades as RGBA8888, lightest (0) to darkest (3). Frames hold
+// shade indices and take the scheme along; it is applied when they are shown.
+struct ColorScheme {
+    Uint32 shades[4];
+};
+constexpr ColorScheme COLOR_SCHEME_GREYSCALE = {{ 0xFFFFFFFF, 0xAAAAAAFF, 0x555555FF, 0x000000FF }};
+constexpr ColorScheme COLOR_SCHEME_DMG_GREEN = {{ 0x9BBC0FFF, 0x8BAC0FFF, 0x306230FF, 0x0F380FFF }};
@@ -0,0 +1,82 @@
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer ring. push() is called from one
+// thread only and pop() from one other thread only; neither locks or blocks.
+// Each side caches the other side's index so the shared cache line is only
+// read when the ring looks full (producer) or empty (consumer).
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false (and drops the item) if the ring is full.
+    bool push(const T& item) {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_HeadCache == Capacity) {
+            m_HeadCache = m_Head.load(std::memory_order_acquire);
+            if (tail - m_HeadCache == Capacity) {
+                return false;
+            }
+        }
+        m_Items[tail & (Capacity - 1)] = item;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if nothing is queued.
+    bool pop(T& item) {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_TailCache) {
+            m_TailCache = m_Tail.load(std::memory_order_acquire);
+            if (head == m_TailCache) {
+                return false;
+            }
+        }
+        item = m_Items[head & (Capacity - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_Head{0};
+    size_t m_TailCache = 0;                     // Consumer's last view of m_Tail
+    alignas(64) std::atomic<size_t> m_Tail{0};
+    size_t m_HeadCache = 0;                     // Producer's last view of m_Head
+    alignas(64) T m_Items[Capacity];
+};
+
+// Control-plane requests from the UI thread to the emulation thread. The
+// emulation thread applies them at frame boundaries (and while paused), so
+// nothing outside it touches the machine while it runs.
+enum class CommandType : BYTE {
+    KEY,                        // key, pressed
+    PAUSE,                      // pause: true pauses, false resumes
+    TOGGLE_PAUSE,
+    TOGGLE_DEBUG,
+    SPEED,                      // numerator / denominator, numerator 0 = uncapped
+    RESET,
+    SAVE_STATE,                 // To the quick-save slot
+    LOAD_STATE,                 // From the quick-save slot
+    SCREENSHOT,                 // Current frame to screenshot_<n>.bmp
+    COLOR_SCHEME                // shades
+};
+
+struct EmulatorCommand {
+    CommandType type;
+    BYTE key;                   // KEY: JOYPAD_RIGHT .. JOYPAD_START
+    bool pressed;               // KEY: pressed or released; PAUSE: pause or resume
+    uint32_t numerator;         // SPEED
+    uint32_t denominator;       // SPEED
+    uint32_t shades[4];         // COLOR_SCHEME: RGBA8888, lightest first
+};
+
+constexpr size_t COMMAND_QUEUE_CAPACITY = 256;
+using CommandQueue = SPSCQueue<EmulatorCommand, COMMAND_QUEUE_CAPACITY>;
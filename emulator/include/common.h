@@ -92,12 +92,25 @@ constexpr BYTE STAT_LYC_INT = 0x40;       // LYC interrupt (bit 6)
 constexpr int MODE_2_CYCLES = 80;         // OAM scan
 constexpr int MODE_3_CYCLES = 172;        // Pixel transfer
 constexpr int MODE_0_CYCLES = 204;        // HBlanks
+constexpr int FRAME_CYCLES = SCANLINE_CYCLES * TOTAL_SCANLINES;  // 70224 cycles per LCD frame
+constexpr WORD LCD_REGISTERS_END = 0xFF4B; // LCDC..WX - accesses bring the PPU up to date first
+constexpr int LCD_REGISTER_COUNT = LCD_REGISTERS_END - LCD_CONTROL + 1;
 
 // DMA Constants
 constexpr WORD DMA_REGISTER = 0xFF46;    // DMA Transfer and Control
 constexpr WORD OAM_START = 0xFE00;       // Start of Sprite Attribute Table
 constexpr WORD OAM_END = 0xFE9F;         // End of Sprite Attribute Table
 constexpr BYTE DMA_LENGTH = 0xA0;        // Length of DMA transfer (160 bytes)
+constexpr int DMA_DURATION_CYCLES = 640; // 160 M-cycles (1 byte per M-cycle)
+
+// Serial port
+constexpr WORD SERIAL_DATA = 0xFF01;      // SB - Serial transfer data
+constexpr WORD SERIAL_CONTROL = 0xFF02;   // SC - Serial transfer control
+constexpr BYTE SERIAL_START_BIT = 0x80;   // SC bit 7: transfer in progress
+constexpr BYTE SERIAL_INTERNAL_CLOCK = 0x01; // SC bit 0: use internal clock
+constexpr int SERIAL_BIT_CYCLES = 512;    // 8192 Hz internal clock
+constexpr BYTE SERIAL_INTERRUPT_BIT = 0x08; // Bit 3
+constexpr int DIV_TICK_CYCLES = 256;      // DIV increments at 16384 Hz
 
 // LCD viewport and scrolling registers
 constexpr WORD SCY_REGISTER = 0xFF42;     // Scroll Y register
@@ -105,6 +118,8 @@ constexpr WORD SCX_REGISTER = 0xFF43;     // Scroll X register
 constexpr WORD WY_REGISTER = 0xFF4A;      // Window Y register
 constexpr WORD WX_REGISTER = 0xFF4B;      // Window X register
 constexpr WORD BGP_REGISTER = 0xFF47;    // Background palette register
+constexpr WORD OBP0_REGISTER = 0xFF48;   // Object palette 0
+constexpr WORD OBP1_REGISTER = 0xFF49;   // Object palette 1
 // Tile map regions
 constexpr WORD BG_TILE_MAP_1 = 0x9800;    // BG tile map region 1
 constexpr WORD BG_TILE_MAP_2 = 0x9C00;    // BG tile map region 2
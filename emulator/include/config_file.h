@@ -0,0 +1,17 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// The settings files (accuracy.cfg, ppu.cfg, threads.cfg) share one line
+// format: "<key> = <value>", with blank lines and '#' comments ignored.
+
+// `text` without leading and trailing whitespace
+std::string trimConfigText(const std::string& text);
+
+// Called for each "<key> = <value>" line, both trimmed. `where` is a
+// "<path>:<line>: " prefix for warnings. Returning false stops reading.
+using ConfigEntry = std::function<bool(const std::string& key, const std::string& value, const std::string& where)>;
+
+// Lines without '=' are logged and skipped. False if the file cannot be
+// opened; a missing file is not an error for any caller, so nothing is logged.
+bool readConfigFile(const std::string& path, const ConfigEntry& entry);
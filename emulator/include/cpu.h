@@ -7,23 +7,17 @@
 #include "logger.h"
 // #include "cpu_constants.h" // Assuming this provides general constants if needed, but not opcode tables
 #include "OpcodeTables.h" // For OpcodeInfo and OpcodeTables class
+#include "accuracy_policy.h"
 
 // Forward declaration
 class MemoryController;
 
 namespace GB {
 
-// Union for CPU register pairs (e.g., AF, BC, DE, HL, SP)
-// Renamed from 'Register' in your original cpu.h to 'RegisterPair'
-// to avoid conflict with GB::Register enum from OpcodeTables.h
-union RegisterPair {
-    WORD reg;
-    struct {
-        BYTE lo;
-        BYTE hi;
-    };
-};
+// RegisterPair and CPUState are defined in machine_state.h
 
+// Registers, flags and run state. Everything that touches the bus lives in
+// CPUCore, which is instantiated once per accuracy policy.
 class CPU {
 public:
     // --- Public Constants for Flags ---
@@ -38,68 +32,50 @@ public:
     static const BYTE FLAG_H_MASK = (1 << FLAG_H_BIT);
     static const BYTE FLAG_C_MASK = (1 << FLAG_C_BIT);
 
-private:
+protected:
     // --- CPU Members ---
     std::shared_ptr<MemoryController> memoryController; // Interface to memory
 
-    // CPU Registers
-    RegisterPair m_RegisterAF;  // Accumulator (A) & Flags (F)
-    RegisterPair m_RegisterBC;  // General Purpose Register Pair BC
-    RegisterPair m_RegisterDE;  // General Purpose Register Pair DE
-    RegisterPair m_RegisterHL;  // General Purpose Register Pair HL / Memory Pointer
-    WORD m_ProgramCounter;      // Program Counter (PC)
-    RegisterPair m_StackPointer;  // Stack Pointer (SP)
-
-    // CPU State
-    bool halted;                // Is CPU in HALT state?
-    bool stopped;               // Is CPU in STOP state?
-    bool interruptEnabled;      // Master Interrupt Enable Flag (IME)
-    bool pendingInterruptEnable; // EI instruction sets this to enable interrupts after the *next* instruction
+    // CPU Registers and state (halt/stop/IME) - lives in the machine state block
+    CPUState& m_Regs;
 
     OpcodeTables& opcodeTables; // Reference to the singleton opcode table instance
 
 public:
     // --- Constructor & Destructor ---
     CPU(std::shared_ptr<MemoryController> memory);
-    ~CPU() = default;
+    virtual ~CPU() = default;
 
-    // --- Core CPU Operations ---
-    int ExecuteNextOpcode(); // Fetches, decodes, and executes the next opcode
     void Reset();            // Resets CPU to its initial state
-    void RequestInterrupt(BYTE interruptBit); // Request an interrupt (sets bit in IF register)
-
-    // --- Memory Access ---
-    // These are used by instruction implementations
-    BYTE readMemory(WORD address) const;
-    void writeMemory(WORD address, BYTE data);
-    BYTE readBytePC(); // Reads byte at current PC and increments PC
-    WORD readWordPC(); // Reads word at current PC and increments PC by 2
+    // Request an interrupt (sets bit in IF register). Not a CPU bus access:
+    // it is called from scheduler events, also in the middle of an instruction.
+    void RequestInterrupt(BYTE interruptBit);
 
     // --- Register Access ---
     // Getters for individual 8-bit registers
-    BYTE& getA() { return m_RegisterAF.hi; }
-    BYTE& getF() { return m_RegisterAF.lo; } // Note: Lower 4 bits of F are always 0
-    BYTE& getB() { return m_RegisterBC.hi; }
-    BYTE& getC() { return m_RegisterBC.lo; }
-    BYTE& getD() { return m_RegisterDE.hi; }
-    BYTE& getE() { return m_RegisterDE.lo; }
-    BYTE& getH() { return m_RegisterHL.hi; }
-    BYTE& getL() { return m_RegisterHL.lo; }
+    BYTE& getA() { return m_Regs.af.hi; }
+    BYTE& getF() { return m_Regs.af.lo; } // Note: Lower 4 bits of F are always 0
+    BYTE& getB() { return m_Regs.bc.hi; }
+    BYTE& getC() { return m_Regs.bc.lo; }
+    BYTE& getD() { return m_Regs.de.hi; }
+    BYTE& getE() { return m_Regs.de.lo; }
+    BYTE& getH() { return m_Regs.hl.hi; }
+    BYTE& getL() { return m_Regs.hl.lo; }
 
     // Getters/Setters for 16-bit register pairs
-    WORD getAF() const { return m_RegisterAF.reg; }
-    void setAF(WORD value) { m_RegisterAF.reg = value; m_RegisterAF.lo &= 0xF0; /* Ensure lower 4 bits of F are zero */ }
-    WORD getBC() const { return m_RegisterBC.reg; }
-    void setBC(WORD value) { m_RegisterBC.reg = value; }
-    WORD getDE() const { return m_RegisterDE.reg; }
-    void setDE(WORD value) { m_RegisterDE.reg = value; }
-    WORD getHL() const { return m_RegisterHL.reg; }
-    void setHL(WORD value) { m_RegisterHL.reg = value; }
-
-    WORD getPC() const { return m_ProgramCounter; }
-    void setPC(WORD value) { m_ProgramCounter = value; }
-    WORD getSP() const { return m_StackPointer.reg; }
-    void setSP(WORD value) { m_StackPointer.reg = value; }
+    WORD getAF() const { return m_Regs.af.reg; }
+    void setAF(WORD value) { m_Regs.af.reg = value; m_Regs.af.lo &= 0xF0; /* Ensure lower 4 bits of F are zero */ }
+    WORD getBC() const { return m_Regs.bc.reg; }
+    void setBC(WORD value) { m_Regs.bc.reg = value; }
+    WORD getDE() const { return m_Regs.de.reg; }
+    void setDE(WORD value) { m_Regs.de.reg = value; }
+    WORD getHL() const { return m_Regs.hl.reg; }
+    void setHL(WORD value) { m_Regs.hl.reg = value; }
+
+    WORD getPC() const { return m_Regs.pc; }
+    void setPC(WORD value) { m_Regs.pc = value; }
+    WORD getSP() const { return m_Regs.sp.reg; }
+    void setSP(WORD value) { m_Regs.sp.reg = value; }
 
     // --- Flag Management ---
     void setFlagZ(bool value);
@@ -113,17 +89,42 @@ public:
     bool getFlagC() const;
 
     // --- CPU State Control ---
-    void setHaltState(bool state) { halted = state; }
-    bool isHalted() const { return halted; }
-    void setStopState(bool state) { stopped = state; } // Note: STOP also involves LCD behavior
-    bool isStopped() const { return stopped; }
-    void enableInterrupts() { interruptEnabled = true; } // For EI instruction effect
-    void disableInterrupts() { interruptEnabled = false;} // For DI instruction effect
-    void scheduleInterruptEnable() { pendingInterruptEnable = true; } // For EI instruction
-    bool isInterruptMasterEnabled() const { return interruptEnabled; }
-    int handleInterrupts();    // Checks and services pending interrupts
+    void setHaltState(bool state) { m_Regs.halted = state; }
+    bool isHalted() const { return m_Regs.halted; }
+    void setStopState(bool state) { m_Regs.stopped = state; } // Note: STOP also involves LCD behavior
+    bool isStopped() const { return m_Regs.stopped; }
+    void enableInterrupts() { m_Regs.ime = true; } // For EI instruction effect
+    void disableInterrupts() { m_Regs.ime = false;} // For DI instruction effect
+    void scheduleInterruptEnable() { m_Regs.pendingIme = true; } // For EI instruction
+    bool isInterruptMasterEnabled() const { return m_Regs.ime; }
+
+protected:
+    // Debug Helpers
+    void logOpcodeExecution(BYTE opcode_val, bool is_prefixed, const OpcodeInfo& info, WORD current_pc_before_fetch);
+};
 
+// Fetch/decode/execute and every CPU bus access, parameterized by the timing
+// policy (InstructionStepped or MCycleAccurate, see accuracy_policy.h). Both
+// instantiations are compiled in cpu.cpp; the emulator picks one per ROM.
+template <typename Policy>
+class CPUCore : public CPU {
+public:
+    using Timing = Policy;
+
+    explicit CPUCore(std::shared_ptr<MemoryController> memory);
 
+    // --- Core CPU Operations ---
+    // Fetches, decodes, and executes the next opcode. Returns its T-cycles;
+    // with TICK_PER_ACCESS the clock has already been advanced by that much.
+    int ExecuteNextOpcode();
+    int handleInterrupts();    // Checks and services pending interrupts
+
+    // --- Memory Access ---
+    // These are used by instruction implementations
+    BYTE readMemory(WORD address);
+    void writeMemory(WORD address, BYTE data);
+    BYTE readBytePC(); // Reads byte at current PC and increments PC
+    WORD readWordPC(); // Reads word at current PC and increments PC by 2
 
     // --- Stack Operations ---
     // Used by PUSH, POP, CALL, RET instructions
@@ -131,13 +132,17 @@ public:
     WORD popStackWord();
 
 private:
+    void tick();                // One M-cycle of a bus access (MCycleAccurate only)
+
     // --- Internal Helper Methods ---
     int processInstruction(const OpcodeInfo& info); // Dispatches to specific instruction handlers
-    int executePrefixedInstruction(); // Handles CB-prefixed instructions
+    int finishInstruction(int cycles); // Puts the cycles not yet ticked on the clock
     int handleUnknownOpcode(BYTE opcode, bool prefixed); // Handles undefined opcodes
 
-    // Debug Helpers
-    void logOpcodeExecution(BYTE opcode_val, bool is_prefixed, const OpcodeInfo& info, WORD current_pc_before_fetch);
+    int m_TickedCycles;         // Cycles of the current instruction already put on the clock
 };
 
+using FastCPU = CPUCore<InstructionStepped>;
+using AccurateCPU = CPUCore<MCycleAccurate>;
+
 } // namespace GB
@@ -9,6 +9,12 @@
 #include <memory_controller.h>
 #include <ppu.h>
 #include <timer.h>
+#include <frame_pacer.h>
+#include <accuracy_policy.h>
+#include <input_log.h>
+#include <command_queue.h>
+#include <color_scheme.h>
+#include <thread_placement.h>
 #include "joypad.h"
 #include <unordered_map>
 #include <functional> // Added for std::function
@@ -16,39 +22,62 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <vector>
 
 // Hardware constants
-constexpr int FRAME_DELAY_MS = 1000 / TARGET_FPS;  // ~16.67ms
+constexpr uint64_t RENDER_INTERVAL_NS = 1000000000ULL / 60;  // UI thread redraws at ~60 Hz
 
 // Keep necessary forward declarations
 class Timer;
 class Joypad;
 class MemoryController;
 class PPU;
-namespace GB { class CPU; class Timer; } // Forward declare CPU in the GB namespace
+namespace GB { class CPU; template <typename Policy> class CPUCore; class Timer; } // Forward declare CPU in the GB namespace
 class Emulator {
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* texture;
+    bool headless;              // No SDL video, window, renderer or texture (see init)
     bool loaded;
     
     // Thread management
     std::thread emulatorThread;
     std::atomic<bool> emulationActive{false};
     std::atomic<bool> running{false}; // Added this
-    std::atomic<float> emulationSpeed{1.0f};
-    std::mutex screenBufferMutex;
-    std::mutex inputMutex; // Added this
-    std::mutex pauseMutex;  // Add this dedicated mutex for pausing
+    std::mutex pauseMutex;  // Only for sleeping while paused - the running loop takes no locks
     std::condition_variable pauseCondition;
     std::atomic<bool> debugMode{false};
     std::atomic<bool> paused{false};
 
     std::shared_ptr<MemoryController> memoryController;
     std::unique_ptr<GB::CPU> cpu;
+    // Typed view of `cpu` - exactly one is set, chosen per ROM (accuracy.cfg)
+    GB::CPUCore<GB::InstructionStepped>* fastCore;
+    GB::CPUCore<GB::MCycleAccurate>* accurateCore;
+    GB::AccuracyMode accuracyMode;
     std::unique_ptr<PPU> ppu;
     std::unique_ptr<GB::Timer> timer;
+    FramePacer pacer;
+    int speedStep;              // Index into the speed ladder (+/- keys)
+    int colorSchemeStep;        // Index into the built-in colour schemes (F2)
+    uint32_t uploadedFrame;     // Sequence of the PPU frame last copied to the texture
+    bool presentNeeded;         // The texture changed or the window needs redrawing
+
+    // Deterministic mode (see setDeterministic)
+    std::atomic<bool> deterministic{false};
+    std::deque<InputEvent> scheduledInputs;     // Sorted by cycle; emulation thread only
+    std::vector<InputEvent> appliedInputs;      // Every input applied so far, for saveInputLog
+
+    CommandQueue commands;                      // UI thread -> emulation thread
+    std::unique_ptr<MachineState> quickSave;    // SAVE_STATE / LOAD_STATE slot
+    int screenshotCount;
+
+    // Host thread placement (threads.cfg) and the emulation thread's scheduling counters
+    ThreadPlacementConfig threadPlacement;
+    ThreadSchedMonitor schedMonitor;
+    bool memoryLocked;
     
     // Changed to use std::function
     std::unordered_map<SDL_Keycode, int> keyMap;
@@ -57,15 +86,67 @@ private:
 public:
     Emulator();
     ~Emulator();
-    bool init();
+    // headless: no window, renderer or texture - only the step API, replays
+    // and screenshots work (getStateHash reads the PPU's frames, not the texture)
+    bool init(bool headless = false);
     void run();
     void cleanup();
     bool loadGame(const std::string& gamePath);
     bool unloadGame();
     void RequestInterrupt(BYTE interruptBit);
     Joypad joypad;
+
+    // Debugger watchpoints (types: WATCH_READ | WATCH_WRITE | WATCH_EXECUTE).
+    // A hit pauses emulation and logs PC, address and old/new value.
+    int addWatchpoint(WORD start, WORD end, BYTE types);
+    bool removeWatchpoint(int id);
+    void clearWatchpoints();
+
+    // Memory access heatmap. CSV columns: frame,scope,name,reads,writes,fetches.
+    // Stopping flushes the CSV and prints a summary. Not while emulation runs.
+    bool startAccessProfiler(const std::string& csvPath, bool perFrame);
+    void stopAccessProfiler();
+
+    // Exact speed ratio (1/2 = half speed); numerator 0 runs uncapped
+    void setEmulationSpeed(uint32_t numerator, uint32_t denominator);
+    // Any four RGBA8888 shades, e.g. COLOR_SCHEME_DMG_GREEN; F2 cycles the built-in ones
+    void setColorScheme(const ColorScheme& scheme);
+
+    // Queues a control command for the emulation thread (see command_queue.h).
+    // Producer side of a single-producer queue: call from the UI thread only.
+    bool postCommand(const EmulatorCommand& command);
+    PacingStats getPacingStats() const { return pacer.stats(); }
+    // Host key event to the guest's first JOYP read that could see it
+    InputLatencyStats getInputLatencyStats() const { return joypad.latencyStats(); }
+    // CPU pinning, SCHED_FIFO and mlockall (see thread_placement.h). Read from
+    // threads.cfg by init(); takes effect on the next startEmulation/run, and
+    // the PPU thread setting on the next loadGame.
+    void setThreadPlacement(const ThreadPlacementConfig& config) { threadPlacement = config; }
+    // Emulation thread context switches and migrations, last full minute
+    ThreadSchedReport getThreadSchedReport() const { return schedMonitor.report(); }
+    // Frames skipped per second are reported in PacingStats::skippedFrames
+    void setFrameskip(FrameskipMode mode, int fixedSkip = 0);
+
+    // Deterministic mode: the guest clock never looks at the wall clock, no
+    // frame is skipped, and input is only applied at defined cycles - from
+    // scheduleInput/loadInputLog, or SDL key changes deferred to the next
+    // frame boundary. The same ROM and input log give bit-identical RAM and
+    // frames. Reset and state-load commands are refused, since the log
+    // cannot replay them. Switch it (and drive the step functions) while
+    // emulation is not running.
+    void setDeterministic(bool enabled);
+    bool isDeterministic() const { return deterministic.load(); }
+    bool stepFrame();                           // Runs to the next FRAME_CYCLES boundary
+    bool stepCycles(uint64_t cycles);           // Runs at least `cycles` (ends on an instruction boundary)
+    void scheduleInput(uint64_t cycle, int key, bool pressed);
+    bool loadInputLog(const std::string& path); // Schedules every event in the file
+    bool saveInputLog(const std::string& path) const;  // Inputs applied so far
+    uint64_t getCycle() const;
+    uint64_t getStateHash() const;              // Machine state block and framebuffer
     
 private:
+    bool initVideo();
+    void cleanupVideo();
     void handleInput(const SDL_Event& event);
     void update();
     void render();
@@ -74,10 +155,20 @@ private:
     void toggleDebugMode();
     void emulationLoop();
     int handleInterrupts();
+    int runToNextEvent(uint64_t limit);
+    bool runUntil(uint64_t target);
+    void applyDueInputs();
+    void applyInput(int key, bool pressed);
+    void checkJoypadInterrupt();
+    template <typename Core> int runCore(Core& core, uint64_t limit);
+    void createCPU(GB::AccuracyMode mode);
+    void reportWatchpointHit();
     BYTE GetJoypadState();
-    void KeyReleased(int key);
-    void KeyPressed(int key);
+    void drainCommands();
+    void applyCommand(const EmulatorCommand& command);
+    void wakeEmulationThread();
+    void resetMachine();
+    bool saveScreenshot();
     void startEmulation();
     void stopEmulation();
-    void setEmulationSpeed(float speed);
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <mutex>
+
+// Wall-clock pacing for the emulation thread.
+//
+// Guest frames are FRAME_CYCLES long, so real time is 4194304 / 70224 Hz
+// (~59.73 fps). Frame ends sit on an absolute cycle grid and every wall
+// deadline is computed from a fixed origin, so CPU overshoot and sleep
+// jitter never accumulate into drift. The speed is an exact ratio that
+// scales wall time, not the cycles run per frame.
+enum class FrameskipMode : BYTE {
+    OFF,                        // Draw every frame
+    FIXED,                      // Draw one frame, then skip a fixed number
+    AUTO                        // Skip while frames run late; when running faster than
+                                // real time draw at most one frame per display refresh
+};
+
+struct PacingStats {
+    double fps;                 // Guest frames per wall second, last window
+    double speed;               // Guest cycles per wall second / CPU_CLOCK_SPEED, last window
+    uint32_t lateFrames;        // Frames that finished after their deadline, last window
+    uint32_t skippedFrames;     // Frames emulated without drawing, last window
+    uint64_t totalFrames;
+    uint64_t totalLateFrames;
+    uint64_t totalSkippedFrames;
+};
+
+class FramePacer {
+public:
+    FramePacer();
+
+    // speed = numerator / denominator; numerator 0 runs uncapped.
+    // May be called from any thread, takes effect at the next frame boundary.
+    void setSpeed(uint32_t numerator, uint32_t denominator);
+    bool isUncapped() const { return m_Numerator == 0; }
+
+    // May be called from any thread; fixedSkip is only used by FIXED
+    void setFrameskip(FrameskipMode mode, int fixedSkip = 0);
+    // Whether the frame about to run should be drawn. Call once per frame,
+    // before running it.
+    bool shouldRenderFrame();
+
+    // Starts a new timeline at the current wall time with the guest clock at
+    // `cycle` (on start and after a pause)
+    void restart(uint64_t cycle);
+
+    // Guest cycle the current frame ends on
+    uint64_t frameEnd() const { return m_FrameEnd; }
+
+    // Called once the guest clock has reached frameEnd(): sleeps until the
+    // frame's wall deadline, updates the statistics and advances to the next
+    // frame. Returns true when a new statistics window was completed.
+    bool endFrame(uint64_t cycle);
+
+    PacingStats stats() const;
+
+private:
+    int64_t deadlineFor(uint64_t cycle) const;  // Wall ns the guest clock should reach `cycle` at
+    void applyPendingSpeed(uint64_t cycle, int64_t wallNow);
+
+    static int64_t nowNs();
+    static void sleepUntil(int64_t deadlineNs);
+
+    // Timeline origin: the guest clock was at m_OriginCycle at wall time m_OriginNs
+    int64_t m_OriginNs;
+    uint64_t m_OriginCycle;
+    uint64_t m_FrameEnd;
+    uint32_t m_Numerator;
+    uint32_t m_Denominator;
+    std::atomic<uint64_t> m_PendingSpeed;   // numerator << 32 | denominator, 0 if none
+
+    // Frameskip
+    std::atomic<FrameskipMode> m_FrameskipMode;
+    std::atomic<int> m_FixedSkip;
+    int m_AutoSkip;                         // Frames skipped per drawn frame under AUTO
+    int m_SkipCountdown;                    // Frames left to skip before the next drawn one
+    int m_OnTimeStreak;                     // Consecutive on-time frames, lowers m_AutoSkip
+    int64_t m_LastRenderNs;
+
+    // Current statistics window
+    int64_t m_WindowStartNs;
+    uint64_t m_WindowStartCycle;
+    uint32_t m_WindowFrames;
+    uint32_t m_WindowLate;
+    uint32_t m_WindowSkipped;
+
+    mutable std::mutex m_StatsMutex;        // Guards m_Stats (read by the UI thread)
+    PacingStats m_Stats;
+};
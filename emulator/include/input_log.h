@@ -0,0 +1,19 @@
+#pragma once
+#include "common.h"
+#include <string>
+#include <vector>
+
+// A joypad change pinned to the guest clock. Deterministic runs take all of
+// their input from a list of these, so a recorded session replays
+// bit-identically.
+struct InputEvent {
+    uint64_t cycle;             // Applied at the first instruction boundary at or after this cycle
+    BYTE key;                   // JOYPAD_RIGHT .. JOYPAD_START
+    bool pressed;
+};
+
+// Text format, one event per line: "<cycle> <key> <1=pressed|0=released>".
+// Blank lines and lines starting with '#' are ignored. Events are returned in
+// file order; they must be sorted by cycle.
+bool loadInputLog(const std::string& path, std::vector<InputEvent>& events);
+bool saveInputLog(const std::string& path, const std::vector<InputEvent>& events);
@@ -1,13 +1,48 @@
 #pragma once
 #include "common.h"
+#include <atomic>
 
+struct InputLatencyStats {
+    uint64_t samples;           // Key changes the guest has read so far
+    double meanUs;              // Host key event -> first guest JOYP read after it
+    double maxUs;
+    double lastUs;
+};
+
+// Button state shared by the UI thread, which publishes key changes the
+// moment SDL delivers them, and the emulation thread, which samples it when
+// the guest reads JOYP. The buttons and the host time of the last change
+// share one atomic word, so a reader always sees a matching pair.
 class Joypad {
 private:
-    BYTE joypadState = 0xFF; // Initialize all buttons as unpressed (1)
+    std::atomic<uint64_t> m_Published;   // stampNs << 8 | state (bit clear = pressed); stamp 0 = not timed
+    BYTE m_SeenPressed;                  // Emulation thread: pressed keys as of the last takeNewPresses
+    uint64_t m_SampledStamp;             // Emulation thread: last stamp a latency sample was taken for
+
+    // Latency statistics - written by the emulation thread, readable from any thread
+    std::atomic<uint64_t> m_Samples;
+    std::atomic<uint64_t> m_TotalNs;
+    std::atomic<uint64_t> m_MaxNs;
+    std::atomic<uint64_t> m_LastNs;
+
+    void update(int key, bool pressed, uint64_t stampNs);
+    static uint64_t nowNs();
 
 public:
-    BYTE GetState(BYTE joypadRequest);
+    Joypad();
+
+    // UI thread: a key went down or up just now
+    void publish(int key, bool pressed);
+    // Emulation thread: key changes applied at a defined guest cycle (replays)
     void KeyPressed(int key);
-    BYTE GetJoypadState() const { return joypadState; }
     void KeyReleased(int key);
-};
\ No newline at end of file
+
+    // JOYP low nibble for the select bits in joypadRequest; called on the
+    // guest's read, which is also where input latency is measured
+    BYTE GetState(BYTE joypadRequest);
+    BYTE GetJoypadState() const { return static_cast<BYTE>(m_Published.load(std::memory_order_acquire)); }
+    // Keys pressed since the previous call, bit per JOYPAD_* key (emulation thread)
+    BYTE takeNewPresses();
+
+    InputLatencyStats latencyStats() const;
+};
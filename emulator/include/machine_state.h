@@ -0,0 +1,199 @@
+#pragma once
+#include "common.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace GB {
+
+// Union for CPU register pairs (e.g., AF, BC, DE, HL, SP)
+// Renamed from 'Register' in your original cpu.h to 'RegisterPair'
+// to avoid conflict with GB::Register enum from OpcodeTables.h
+union RegisterPair {
+    WORD reg;
+    struct {
+        BYTE lo;
+        BYTE hi;
+    };
+};
+
+struct CPUState {
+    RegisterPair af;            // Accumulator (A) & Flags (F)
+    RegisterPair bc;            // General Purpose Register Pair BC
+    RegisterPair de;            // General Purpose Register Pair DE
+    RegisterPair hl;            // General Purpose Register Pair HL / Memory Pointer
+    RegisterPair sp;            // Stack Pointer (SP)
+    WORD pc;                    // Program Counter (PC)
+    bool halted;                // Is CPU in HALT state?
+    bool stopped;               // Is CPU in STOP state?
+    bool ime;                   // Master Interrupt Enable Flag (IME)
+    bool pendingIme;            // EI enables interrupts after the *next* instruction
+};
+
+} // namespace GB
+
+struct MBCState {
+    BYTE romBank;               // Currently mapped ROM bank at 0x4000-0x7FFF
+    BYTE ramBank;               // Currently mapped external RAM bank
+    bool ramEnabled;
+    bool romBankingMode;        // MBC1 ROM/RAM banking mode select
+};
+
+// DIV and TIMA are not stored as counters - they are derived from the
+// scheduler clock when read (see GB::Timer)
+struct TimerState {
+    uint64_t divBase;           // Cycle DIV was last reset; DIV = (now - divBase) / 256
+    uint64_t timaBase;          // Cycle timaValue was last materialized
+    BYTE timaValue;             // TIMA as of timaBase
+};
+
+struct PPUState {
+    BYTE mode;                  // STAT mode as of lastCycle (0-3)
+    BYTE transferExtra;         // Current line's mode 3 cycles beyond 172 (PPU engine dependent)
+};
+
+// The PPU runs lazily: it only catches up to the clock when observed (see PPU::catchUp)
+struct PPUTiming {
+    uint64_t frameStart;        // Cycle the current frame's line 0 began
+    uint64_t lastCycle;         // Cycle LY/STAT and the framebuffer are caught up to
+};
+
+struct SerialState {
+    BYTE bitsRemaining;         // Bits left in the current internal-clock transfer
+};
+
+struct DMAState {
+    uint64_t startCycle;        // Scheduler cycle the current transfer started on
+    WORD source;                // Source address of the current transfer
+    bool active;                // Set while an OAM DMA holds the bus
+};
+
+// Events the scheduler tracks - one pending deadline per kind
+enum class SchedulerEvent : BYTE {
+    PPU_INTERRUPT,              // Next PPU point that raises VBlank or an enabled STAT interrupt
+    TIMA_OVERFLOW,              // TIMA wraps: reload from TMA, timer interrupt
+    DMA_COMPLETE,               // OAM DMA releases the bus
+    SERIAL_SHIFT,               // Next serial bit shifted out
+    COUNT
+};
+constexpr int SCHEDULER_EVENT_COUNT = static_cast<int>(SchedulerEvent::COUNT);
+constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+struct SchedulerState {
+    uint64_t now;               // Master T-cycle counter
+    uint64_t nextDeadline;      // Earliest entry of deadlines[], cached
+    uint64_t deadlines[SCHEDULER_EVENT_COUNT];  // Absolute cycle, NO_DEADLINE if idle
+};
+
+// All mutable guest state of one machine in a single trivially-copyable block.
+// Cloning and serializing a machine is a memcpy of sizeof(MachineState);
+// hashMachineState hashes it field by field.
+// The ROM is not part of it - it is shared through RomImage.
+//
+// Layout: registers, IE and the PPU/serial/DMA state fill the first cache
+// line, the scheduler clock, deadlines and PPU timestamps the second, the IO page (IF, DIV,
+// TIMA, TAC, LCDC, STAT, LY, ...) the next two. Bulk memory follows.
+struct alignas(64) MachineState {
+    // --- Cache line 0 ---
+    GB::CPUState cpu;
+    BYTE interruptEnable;       // IE (0xFFFF)
+    MBCState mbc;
+    PPUState ppu;
+    SerialState serial;
+    DMAState dma;
+    TimerState timer;
+
+    // --- Cache line 1 ---
+    alignas(64) SchedulerState scheduler;
+    PPUTiming ppuTiming;
+
+    // --- Cache lines 2-3: 0xFF00-0xFF7F ---
+    alignas(64) BYTE io[0x80];
+    BYTE hram[0x7F];            // 0xFF80-0xFFFE
+
+    alignas(64) BYTE oam[0xA0]; // 0xFE00-0xFE9F
+    alignas(64) BYTE vram[0x2000];        // 0x8000-0x9FFF
+    BYTE wram[0x2000];                    // 0xC000-0xDFFF
+    BYTE externalRAM[0x8000];             // 0xA000-0xBFFF, 4 banks of 8KB
+
+    // Offset helpers for the IO page
+    static constexpr WORD ioIndex(WORD address) { return address - 0xFF00; }
+    BYTE& ioRegister(WORD address) { return io[ioIndex(address)]; }
+    BYTE ioRegister(WORD address) const { return io[ioIndex(address)]; }
+};
+
+static_assert(std::is_trivially_copyable<MachineState>::value, "MachineState must stay memcpy-able");
+static_assert(offsetof(MachineState, scheduler) == 64, "Hot fields must fit in the first cache line");
+static_assert(offsetof(MachineState, io) == 128, "Scheduler and PPU timing must fit in one cache line");
+
+constexpr size_t MACHINE_STATE_SIZE = sizeof(MachineState);
+
+// 64-bit FNV-1a over every field, member by member. Padding is left out: a
+// member-wise assignment of a sub-struct may leave it different, and two
+// machines in the same state must hash the same.
+class MachineStateHash {
+public:
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_integral<T>::value, "Hash fields, not structs - structs may have padding");
+        addBytes(reinterpret_cast<const BYTE*>(&value), sizeof(value));
+    }
+    void addBytes(const BYTE* bytes, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            m_Hash ^= bytes[i];
+            m_Hash *= 0x100000001B3ULL;
+        }
+    }
+    uint64_t value() const { return m_Hash; }
+
+private:
+    uint64_t m_Hash = 0xCBF29CE484222325ULL;
+};
+
+// A new field changes its struct's size: add it to hashMachineState, then here
+static_assert(sizeof(GB::CPUState) == 16 && sizeof(MBCState) == 4 && sizeof(TimerState) == 24 &&
+              sizeof(PPUState) == 2 && sizeof(PPUTiming) == 16 && sizeof(SerialState) == 1 &&
+              sizeof(DMAState) == 16 && sizeof(SchedulerState) == 48 && sizeof(MachineState) == 49728,
+              "MachineState changed: update hashMachineState");
+
+inline uint64_t hashMachineState(const MachineState& state) {
+    MachineStateHash hash;
+    const GB::CPUState& cpu = state.cpu;
+    hash.add(cpu.af.reg);
+    hash.add(cpu.bc.reg);
+    hash.add(cpu.de.reg);
+    hash.add(cpu.hl.reg);
+    hash.add(cpu.sp.reg);
+    hash.add(cpu.pc);
+    hash.add(cpu.halted);
+    hash.add(cpu.stopped);
+    hash.add(cpu.ime);
+    hash.add(cpu.pendingIme);
+    hash.add(state.interruptEnable);
+    hash.add(state.mbc.romBank);
+    hash.add(state.mbc.ramBank);
+    hash.add(state.mbc.ramEnabled);
+    hash.add(state.mbc.romBankingMode);
+    hash.add(state.ppu.mode);
+    hash.add(state.ppu.transferExtra);
+    hash.add(state.serial.bitsRemaining);
+    hash.add(state.dma.startCycle);
+    hash.add(state.dma.source);
+    hash.add(state.dma.active);
+    hash.add(state.timer.divBase);
+    hash.add(state.timer.timaBase);
+    hash.add(state.timer.timaValue);
+    hash.add(state.scheduler.now);
+    hash.add(state.scheduler.nextDeadline);
+    for (uint64_t deadline : state.scheduler.deadlines) {
+        hash.add(deadline);
+    }
+    hash.add(state.ppuTiming.frameStart);
+    hash.add(state.ppuTiming.lastCycle);
+    hash.addBytes(state.io, sizeof(state.io));
+    hash.addBytes(state.hram, sizeof(state.hram));
+    hash.addBytes(state.oam, sizeof(state.oam));
+    hash.addBytes(state.vram, sizeof(state.vram));
+    hash.addBytes(state.wram, sizeof(state.wram));
+    hash.addBytes(state.externalRAM, sizeof(state.externalRAM));
+    return hash.value();
+}
@@ -3,27 +3,43 @@
 #include "logger.h"
 #include <vector>
 #include <memory_region.h>
+#include <machine_state.h>
+#include <byte_span.h>
+#include <watchpoints.h>
+#include <access_profiler.h>
+#include <scheduler.h>
 #include <ram.h>
 #include <cart.h>
 #include <memory>
 #include <emulator.h>
 class Emulator; // Forward declaration of Emulator class
+class PPU;
+namespace GB { class Timer; }
 
 
 class MemoryController {
     private:
-        std::unique_ptr<RAM> ram;
+        std::unique_ptr<MachineState> m_State; // All mutable guest state (registers, RAM, IO)
+        std::unique_ptr<RAM> ram;              // Address decoding over m_State
+        std::unique_ptr<Scheduler> m_Scheduler; // Clock and deadlines live in m_State->scheduler
         std::unique_ptr<Cart> cart;
+        const RomImage* m_Rom;                 // ROM held by reference, owned by the cart
         Emulator* emulator; // Pointer to the Emulator instance
+        GB::Timer* m_Timer;  // Notified of DIV/TIMA/TMA/TAC writes
+        PPU* m_PPU;          // Notified of LCDC writes
 
-        // Banking related members
-        bool m_EnableRAM;
-        bool m_ROMBanking;
+        // Banking configuration (from the cartridge header - the bank
+        // registers themselves live in m_State->mbc)
         bool m_MBC1;
         bool m_MBC2;
-        BYTE m_CurrentROMBank;
-        BYTE m_CurrentRAMBank;
-        std::vector<BYTE> m_RAMBanks;
+
+        // Debugger watchpoints - mutable since reads can hit them. The page
+        // flags also gate the access profiler's slow path.
+        mutable Watchpoints m_Watchpoints;
+        std::unique_ptr<AccessProfiler> m_Profiler;  // Null unless profiling
+        WORD m_InstructionPC;  // PC of the instruction currently executing
+        bool m_ResumingExecuteHit;  // The next instruction start is the one an execute hit stopped at
+        WORD m_ExecuteHitPC;
 
     public:
         MemoryController();
@@ -34,23 +50,80 @@ class MemoryController {
         void write(WORD address, BYTE data);
         void doDMATransfer(BYTE data);
         void RequestInterrupt(BYTE interrupt);
-        // Direct VRAM access for PPU
-        const BYTE getVRAM() const { 
-            if (!ram) {
-                LOG_ERROR("Attempting to access VRAM with null RAM");
-                return 0;
+
+        // CPU-side bus access - identical to read/write unless an OAM DMA is in
+        // flight or the page has a watchpoint on it
+        BYTE cpuRead(WORD address) const {
+            BYTE value = busRead(address);
+            if (m_Watchpoints.isPageWatched(address, WATCH_READ)) {
+                instrumentedAccess(address, WATCH_READ, value, value);
             }
-            return ram->read(0x8000); 
+            return value;
+        }
+        void cpuWrite(WORD address, BYTE data) {
+            if (m_State->dma.active && isLockedDuringDMA(address)) return;
+            if (isPPUBus(address) && isLockedByPPU(address)) return;
+            if (m_Watchpoints.isPageWatched(address, WATCH_WRITE)) {
+                watchedWrite(address, data);
+                return;
+            }
+            write(address, data);
+        }
+        // Opcode, CB-prefix and operand fetch - counted by the profiler, not
+        // reported to read watchpoints
+        BYTE cpuFetch(WORD address) const {
+            if (m_Profiler) m_Profiler->record(address, ACCESS_FETCH);
+            return busRead(address);
         }
-        
-        const BYTE getOAM() const { 
-            if (!ram) {
-                LOG_ERROR("Attempting to access OAM with null RAM");
-                return 0;
+        // Called by the CPU before fetching each instruction. True when an
+        // execute watchpoint hit: the instruction must not be fetched or run.
+        bool beginInstruction(WORD pc) {
+            m_InstructionPC = pc;
+            bool resuming = m_ResumingExecuteHit;
+            m_ResumingExecuteHit = false;
+            if (m_Watchpoints.isPageWatched(pc, WATCH_EXECUTE)) {
+                return watchedExecute(pc, resuming);
             }
-            return ram->read(0xFE00); 
+            return false;
         }
-        
+        bool isDMAActive() const { return m_State->dma.active; }
+
+        // Event scheduler shared by the CPU loop and the peripherals
+        Scheduler& scheduler() { return *m_Scheduler; }
+        const Scheduler& scheduler() const { return *m_Scheduler; }
+        // One bus M-cycle of the accurate CPU core: moves the clock and runs
+        // what came due, so the access that follows sees that cycle's state
+        void tickMCycle() {
+            m_Scheduler->advance(4);
+            if (m_Scheduler->hasDueEvents()) m_Scheduler->runDueEvents();
+        }
+
+        // Watchpoints - a hit is latched until the emulation loop takes it
+        Watchpoints& watchpoints() { return m_Watchpoints; }
+        bool hasWatchHit() const { return m_Watchpoints.hasHit(); }
+        // Emulation thread: takes the hit. After an execute hit the instruction
+        // it stopped at runs once without hitting again, so resuming moves on.
+        WatchHit takeWatchHit();
+
+        // Access heatmap profiler - routes all pages through the slow path while set
+        void startProfiler(std::unique_ptr<AccessProfiler> profiler);
+        std::unique_ptr<AccessProfiler> stopProfiler();
+        void endProfilerFrame() { if (m_Profiler) m_Profiler->endFrame(); }
+        bool isProfiling() const { return m_Profiler != nullptr; }
+
+        // Machine state block - clone/serialize with a plain copy of MACHINE_STATE_SIZE bytes
+        MachineState& state() { return *m_State; }
+        const MachineState& state() const { return *m_State; }
+        void saveState(MachineState& out) const { memcpy(&out, m_State.get(), sizeof(MachineState)); }
+        void loadState(const MachineState& in);
+        // Views the PPU draws from: no region decoding, watchpoints or mode
+        // locks. Those apply to the CPU side (cpuRead/cpuWrite) only.
+        ByteSpan getVRAM() const { return ByteSpan(m_State->vram, sizeof(m_State->vram)); }                // 0x8000-0x9FFF
+        ByteSpan getOAM() const { return ByteSpan(m_State->oam, sizeof(m_State->oam)); }                   // 0xFE00-0xFE9F
+        ByteSpan getLCDRegisters() const {                                                                  // 0xFF40-0xFF4B
+            return ByteSpan(&m_State->ioRegister(LCD_CONTROL), LCD_REGISTERS_END - LCD_CONTROL + 1);
+        }
+
         // Cart management
         bool attachCart(std::unique_ptr<Cart> newCart);
         bool detachCart();
@@ -67,9 +140,41 @@ class MemoryController {
             emulator = newEmulator;
             return emulator != nullptr;
         }
+        // Peripherals whose events must be rescheduled on register writes (nullptr detaches)
+        void attachTimer(GB::Timer* timer) { m_Timer = timer; }
+        void attachPPU(PPU* ppu) { m_PPU = ppu; }
 
 
     private:
+        BYTE busRead(WORD address) const {
+            if (m_State->dma.active) return readDuringDMA(address);
+            if (isPPUBus(address) && isLockedByPPU(address)) return BYTE_MASK;
+            return read(address);
+        }
+        void watchedWrite(WORD address, BYTE data);
+        const BYTE* backingByte(WORD address) const;
+        bool watchedExecute(WORD pc, bool resuming);
+        bool instrumentedAccess(WORD address, BYTE type, BYTE oldValue, BYTE newValue) const;
+
+        // IO register writes that affect scheduled events
+        void writeIO(WORD address, BYTE data);
+
+        // Scheduler event handlers
+        void onDMAComplete(uint64_t deadline);
+        void onSerialShift(uint64_t deadline);
+
+        // OAM DMA helpers
+        const BYTE* resolveDMASource(WORD sourceAddress) const;
+        bool isLockedDuringDMA(WORD address) const;
+        BYTE readDuringDMA(WORD address) const;
+
+        // PPU access modes: VRAM is closed to the CPU during pixel transfer
+        // (mode 3), OAM during the OAM scan and pixel transfer (modes 2-3)
+        static bool isPPUBus(WORD address) {
+            return static_cast<WORD>(address - 0x8000) < 0x2000 || static_cast<WORD>(address - OAM_START) < 0xA0;
+        }
+        bool isLockedByPPU(WORD address) const;
+
         // Banking helpers
         void HandleBanking(WORD address, BYTE data);
         void DoRamBankEnable(WORD address, BYTE data);
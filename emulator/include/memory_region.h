@@ -16,6 +16,7 @@ enum class MemoryRegion {
     JOYPAD_REGISTER,    // 0xFF00
     INTERRUPT_ENABLE    // 0xFFFF
 };
+constexpr int MEMORY_REGION_COUNT = static_cast<int>(MemoryRegion::INTERRUPT_ENABLE) + 1;
 
 inline MemoryRegion getMemoryRegion(WORD address) {
     if (address <= 0x3FFF) return MemoryRegion::ROM_BANK_0;
@@ -26,10 +27,10 @@ inline MemoryRegion getMemoryRegion(WORD address) {
     if (address <= 0xFDFF) return MemoryRegion::ECHO_RAM;
     if (address <= 0xFE9F) return MemoryRegion::SPRITE_TABLE;
     if (address <= 0xFEFF) return MemoryRegion::RESTRICTED;
+    if (address == JOYPAD_REGISTER) return MemoryRegion::JOYPAD_REGISTER;
+    if (address == DMA_REGISTER) return MemoryRegion::DMA_REGISTER;
     if (address <= 0xFF7F) return MemoryRegion::IO_PORTS;
     if (address <= 0xFFFE) return MemoryRegion::HRAM;
-    if (address == DMA_REGISTER) return MemoryRegion::DMA_REGISTER;
-    if (address == JOYPAD_REGISTER) return MemoryRegion::JOYPAD_REGISTER;
     return MemoryRegion::INTERRUPT_ENABLE;
 }
 
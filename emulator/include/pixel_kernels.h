@@ -0,0 +1,49 @@
+#pragma once
+#include "common.h"
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Scanline pixel kernels, in a scalar version and SIMD versions picked at
+// runtime for the host CPU. All versions produce identical output.
+struct PixelKernels {
+    const char* name;
+    // 2bpp tile rows to colour indices: `rows` pairs of bitplane bytes (low
+    // plane first, leftmost pixel in bit 7) become rows * 8 indices 0-3
+    void (*decodeRows)(const BYTE* planes, int rows, BYTE* indices);
+    // Colour indices through a 4-entry byte table (BGP/OBP: colour index -> shade)
+    void (*mapIndices)(const BYTE* indices, int count, const BYTE* table, BYTE* out);
+    // Colour indices through a 4-entry RGBA8888 palette
+    void (*expandIndices)(const BYTE* indices, int count, const Uint32* palette, Uint32* out);
+    // Colour indices through a 4-entry 16-bit (RGB565) palette
+    void (*expandIndices16)(const BYTE* indices, int count, const Uint16* palette, Uint16* out);
+};
+
+// Fastest kernels the host supports; chosen once on first use
+const PixelKernels& pixelKernels();
+// Every version this host can run, scalar first
+std::vector<const PixelKernels*> availablePixelKernels();
+
+struct PixelKernelTiming {
+    const char* name;
+    double decodeNsPerLine;     // 20 tile rows decoded
+    double mapNsPerLine;        // 160 indices through BGP
+    double expandNsPerLine;     // 160 indices through the palette
+    bool matchesScalar;
+};
+
+// Microbenchmark: ns per 160-pixel scanline for every available version,
+// logged and returned
+std::vector<PixelKernelTiming> benchmarkPixelKernels(int lines = 200000);
+
+// Pixel formats a finished frame can be converted to
+enum class FramePixelFormat {
+    RGBA8888,                   // The colour scheme's own format and the SDL texture's
+    BGRA8888,
+    RGB565
+};
+
+// Frame consumers: `height` rows of `width` shade indices (0-3, lightest
+// first) through the four RGBA8888 shades of a colour scheme, into `out`
+// with `pitch` bytes per row
+void convertShades(const BYTE* shades, int width, int height, const Uint32* palette,
+                   FramePixelFormat format, void* out, int pitch);
@@ -3,6 +3,10 @@
 #include <memory>
 #include "memory_controller.h"
 #include "logger.h"
+#include "color_scheme.h"
+#include "ppu_engine.h"
+#include "ppu_worker.h"
+#include "triple_buffer.h"
 #include <array>
 #include <thread>
 #include <mutex>
@@ -10,45 +14,165 @@
 #include <atomic>
 #include <chrono>
 class MemoryController; // Forward declaration of MemoryController class
+
+// A completed frame as handed from the emulation thread to the renderer
+struct PPUFrame {
+    std::vector<BYTE> shades;       // 160x144 shade indices, 0 lightest - 3 darkest
+    Uint32 palette[4];              // RGBA8888 of each shade: the colour scheme when published
+    uint32_t sequence;              // getPresentedFrameCount() when it was published
+};
+
 class PPU {
 private:
     std::shared_ptr<MemoryController> memoryController;
-    int scanlineCounter;
+    MachineState& m_State;      // LY and STAT are written here; everything else is read through the views below
+    ByteSpan m_VRAM;            // 0x8000-0x9FFF
+    ByteSpan m_OAM;             // 0xFE00-0xFE9F
+    ByteSpan m_LCDRegisters;    // 0xFF40-0xFF4B
+    Scheduler& m_Scheduler;     // Only interrupt-raising points are scheduled (PPU_INTERRUPT)
+    PPUTiming& m_Timing;
     bool lcdEnabled;
-    BYTE currentMode;
-    std::vector<Uint32> screenBuffer;
-    std::mutex bufferMutex;
+    BYTE& currentMode;          // Lives in the machine state block
+    TileCache m_TileCache;      // Decoded tiles, invalidated by VRAM writes
+    SpriteLines m_SpriteLines;  // Per-line sprite lists, invalidated by OAM writes and DMA
+    const PixelKernels& m_Kernels;                  // SIMD or scalar, picked for the host CPU
+    ColorScheme m_Scheme;
+    // BGP, OBP0 and OBP1: colour index -> shade. Rebuilt when the guest
+    // writes a palette register.
+    BYTE m_BGShades[4];
+    BYTE m_OBJShades[2][4];
+    TripleBuffer<PPUFrame> m_Frames;                // Drawn into back(), published at VBlank
+    PPURenderContext m_Context;                     // What the engine draws from and into
+    std::unique_ptr<PPUEngine> m_Engine;
+    bool m_LineOpen = false;                        // The engine is drawing the current line's mode 3
+    uint64_t m_ModeValidUntil = 0;                  // Cycle of the first mode boundary after the last catch-up
     BYTE prevLCDControl = 0;
     BYTE prevBGP = 0;
     bool frameRendered = false;
     int frameCount = 0;
+    bool m_SkipRequested = false;
+    bool m_SkipFrame = false;                       // Latched at line 0
+    std::atomic<uint32_t> m_PresentedFrames{0};     // Completed frames that were drawn
+    // Change tracking of drawn frames: each row's hash as last drawn and the
+    // presented-frame number of the last frame that changed it
+    uint64_t m_RowHashes[SCREEN_PIXELS_HEIGHT] = {};
+    std::atomic<uint32_t> m_RowChanged[SCREEN_PIXELS_HEIGHT] = {};
+    bool m_FrameChanged = false;                    // A row of the frame being drawn differs from the last one
+    std::atomic<uint64_t> m_FrameHash{0};           // Of the last presented frame
+    std::atomic<uint32_t> m_ChangedFrames{0};       // Presented frames that differed from the one before
+    bool m_WorkerRequested = false;
+    ThreadPlacementConfig m_WorkerPlacement;
+    std::unique_ptr<PPUWorker> m_Worker;            // Last member: stops before anything it draws into goes away
     
 
 public:
     explicit PPU(std::shared_ptr<MemoryController> memory);  // Add explicit keyword
-    ~PPU() = default;
-    void update(int cycles);
+    ~PPU();
     bool isLCDEnabled() const;
-    
-    const std::vector<Uint32>& getScreenBuffer() const {
-        return screenBuffer;
+    // Brings LY, STAT and the framebuffer up to the current cycle. The memory
+    // controller calls this before the CPU touches VRAM, OAM or an LCD register,
+    // and the emulator at the end of every frame.
+    void catchUp();
+    // True while no mode boundary has passed since the last catch-up, so the
+    // mode in STAT is still current and catchUp() would not change it
+    bool isModeCurrent() const { return m_Scheduler.now() < m_ModeValidUntil; }
+    // Called by the memory controller when LCDC is written; starts or stops the PPU
+    void onLCDControlWrite(BYTE previous, BYTE value);
+    // Called after STAT or LYC is written; the next interrupt point may have moved
+    void onStatusWrite();
+    // Called after the CPU writes VRAM (the PPU has already caught up)
+    void onVRAMWrite(WORD address) {
+        m_TileCache.invalidate(address);
+        if (m_Worker) {
+            m_Worker->onVRAMWrite(address);
+        }
+    }
+    // Called after OAM is written by the CPU or a DMA transfer
+    void onOAMWrite() {
+        m_SpriteLines.invalidate();
+        if (m_Worker) {
+            m_Worker->onOAMWrite();
+        }
     }
+    // Called after BGP, OBP0 or OBP1 is written
+    void onPaletteWrite(WORD address) { rebuildPalette(address); }
+    // Called when the machine state was replaced as a whole (state load)
+    void onStateLoaded();
+    void setColorScheme(const ColorScheme& scheme);
+    // Replaces the rendering engine; takes effect from the next line
+    void setEngine(PPUEngineKind kind);
+    // Draws on a worker thread (PPUWorker) while the scanline engine is
+    // selected; the FIFO engine always draws inline
+    void setRenderThread(bool enabled, const ThreadPlacementConfig& placement);
+    bool isRenderThreaded() const { return m_Worker != nullptr; }
+    PPUEngineKind getEngineKind() const { return m_Engine->kind(); }
+    const ColorScheme& getColorScheme() const { return m_Scheme; }
+    
+    // Emulation thread: the last completed frame (waits for the worker to draw it)
+    const PPUFrame& getLastFrame();
+    // Emulation thread: the last completed frame as RGBA8888
+    std::vector<Uint32> getScreenBuffer();
+    // Render thread (one consumer): the newest completed frame, switching to
+    // it if one was published since the last call; `fresh` tells whether it
+    // did. The frame stays valid and unchanged until the next call.
+    const PPUFrame& acquireFrame(bool& fresh);
+    // Frameskip: a skipped frame keeps exact LY/STAT/interrupt timing but
+    // draws no pixels. Takes effect at the next frame's line 0.
+    void setSkipRendering(bool skip) { m_SkipRequested = skip; }
+    // Changes whenever a drawn frame is complete; the renderer only uploads on a change
+    uint32_t getPresentedFrameCount() const { return m_PresentedFrames.load(std::memory_order_acquire); }
+    // 64-bit hash of the last presented frame; equal hashes mean equal pixels
+    uint64_t getFrameHash() const { return m_FrameHash.load(std::memory_order_acquire); }
+    // Presented frames whose pixels differ from the previous presented frame
+    uint32_t getChangedFrameCount() const { return m_ChangedFrames.load(std::memory_order_acquire); }
+    // Rows changed by frames presented after `sinceFrame` (a PPUFrame sequence):
+    // false when none did, else the first and last such row. Rows of the
+    // frame being drawn may be included.
+    bool getDirtyRows(uint32_t sinceFrame, int& firstRow, int& lastRow) const;
     void debugFillTestPattern();
     void reset() ; // Reset the PPU state
 
 
 private:
-    void drawScanline();
-    void requestVBlankInterrupt();
-    void updateScanline();
-    void updateLCDStatus();
-    void setLCDStatus(BYTE mode);
-    void checkLYCInterrupt();
-    void renderTiles();
-    void renderSprites();
-    void setPixel(int x, int y, Uint32 color);
-    int getColorFromPalette(BYTE palette, int colorId);
+    // Mode boundaries within a frame: line start (LY changes, mode 2 or 1),
+    // start of pixel transfer (the line is drawn) and start of HBlank
+    enum PointKind { LINE_START, LINE_TRANSFER, LINE_HBLANK };
+    struct LinePoint {
+        uint32_t position;      // Cycles since frame start; FRAME_CYCLES = next frame's line 0
+        int line;
+        PointKind kind;
+    };
+    LinePoint nextPoint(uint32_t position) const;   // First point strictly after position
+
+    void catchUpTo(uint64_t cycle);
+    void enterPoint(int line, PointKind kind);
+    BYTE interruptsAt(int line, PointKind kind) const;  // IF bits raised at that point
+    void scheduleNextInterrupt();
+    void onInterruptPoint(uint64_t deadline);           // PPU_INTERRUPT scheduler event
+    void startFrame();
+    void setMode(BYTE mode);                            // Mode and LYC=LY bits of STAT
+    BYTE reg(WORD address) const { return m_LCDRegisters[address - LCD_CONTROL]; }  // LCDC..WX only
+    void setPixel(int x, int y, BYTE shade);
+    // Frame bookkeeping, on whichever thread draws (emulation or worker)
+    void trackLine(int line, const BYTE* shades, uint32_t frame);  // A line of frame `frame` was drawn: did it change?
+    BYTE* completeFrame(uint32_t sequence);             // Frame hash and change count, then publishFrame
+    BYTE* publishFrame(uint32_t sequence);              // Hands the back buffer over; returns the next one
+    void markAllRowsChanged();                          // The buffer was rewritten outside the engine
+    void updateWorker();
+    void syncWorker();                                  // Waits for queued lines; the frames are ours afterwards
+    void rebuildPalette(WORD address);
     uint32_t calculateBufferChecksum();
     void monitorRegisterChanges();
-    Uint32 mapColorToSDL(int r, int g, int b, int a = 255);
-};
\ No newline at end of file
+};
+
+struct PPUEngineTiming {
+    PPUEngineKind kind;
+    bool threaded;              // Drawn by the PPU worker thread
+    double usPerFrame;          // Emulation thread time; a threaded run includes waiting for the last frame
+};
+
+// Microbenchmark: draws `frames` frames of a synthetic scene (scrolled BG,
+// window, ten sprites on most lines) with each engine, and the scanline
+// engine again on the worker thread, caught up once per line; logged and
+// returned
+std::vector<PPUEngineTiming> benchmarkPPUEngines(int frames = 600);
@@ -0,0 +1,137 @@
+#pragma once
+#include "common.h"
+#include "byte_span.h"
+#include "pixel_kernels.h"
+#include "sprite_lines.h"
+#include "tile_cache.h"
+#include <memory>
+#include <string>
+
+// How the PPU turns VRAM into pixels. The PPU owns the mode timing and only
+// asks the engine how long each line's pixel transfer takes and to draw it.
+enum class PPUEngineKind : BYTE {
+    SCANLINE,                   // Whole line at the start of mode 3, fixed 172-cycle transfer
+    FIFO                        // Dot by dot through the pixel fetcher and FIFOs
+};
+
+constexpr const char* PPU_CONFIG_FILE = "ppu.cfg";
+
+// Looks the ROM up in the PPU config: "<rom file name or header title> =
+// scanline|fifo" lines and an optional "default" entry. A missing file or
+// entry means SCANLINE.
+PPUEngineKind ppuEngineForRom(const std::string& configPath, const std::string& romPath, const std::string& romTitle);
+const char* ppuEngineName(PPUEngineKind kind);
+
+// What an engine draws from and into. Owned by the PPU and held by reference:
+// the palette tables follow BGP/OBP writes, and `frame` moves to a new buffer
+// whenever a completed frame is published. Engines output shade indices
+// (0 lightest - 3 darkest); colours are applied by whoever shows the frame.
+struct PPURenderContext {
+    ByteSpan vram;                      // 0x8000-0x9FFF
+    ByteSpan lcdRegisters;              // 0xFF40-0xFF4B
+    ByteSpan oam;                       // 0xFE00-0xFE9F
+    TileCache& tiles;
+    SpriteLines& sprites;
+    const PixelKernels& kernels;
+    const BYTE* bgShades;               // BGP: colour index -> shade
+    const BYTE (*objShades)[4];         // OBP0, OBP1
+    BYTE* frame;                        // 160x144 shade indices, the buffer being drawn
+
+    BYTE reg(WORD address) const { return lcdRegisters[address - LCD_CONTROL]; }  // LCDC..WX only
+    BYTE* line(int y) const { return frame + static_cast<size_t>(y) * SCREEN_PIXELS_WIDTH; }
+};
+
+class PPUEngine {
+public:
+    virtual ~PPUEngine() = default;
+    virtual PPUEngineKind kind() const = 0;
+
+    // Start of mode 3 on every visible line, drawn or skipped: the transfer
+    // length in cycles for the registers and sprites as they are now
+    virtual int transferCycles(int line) = 0;
+    // Drawn lines only, right after transferCycles
+    virtual void beginLine(int line) = 0;
+    // Mode 3 has run for `dots` cycles: output what the hardware has by then.
+    // The PPU catches up before every VRAM, OAM and LCD register write, so
+    // everything up to `dots` used the old values.
+    virtual void advance(int dots) = 0;
+    // Start of HBlank: finish the line
+    virtual void endLine() = 0;
+};
+
+std::unique_ptr<PPUEngine> createPPUEngine(PPUEngineKind kind, const PPURenderContext& context);
+
+// Draws each line in one pass at the start of mode 3 from decoded tile rows
+// and the per-line sprite list. Mid-line register writes land on the next line.
+class ScanlineEngine : public PPUEngine {
+public:
+    explicit ScanlineEngine(const PPURenderContext& context);
+
+    PPUEngineKind kind() const override { return PPUEngineKind::SCANLINE; }
+    int transferCycles(int line) override;
+    void beginLine(int line) override;
+    void advance(int /*dots*/) override {}
+    void endLine() override {}
+
+private:
+    void renderTiles(int line);
+    void fetchTileRow(WORD tileMap, BYTE mapX, BYTE mapY, bool unsignedIndexing, BYTE* out, int count);
+    void renderSprites(int line);
+
+    const PPURenderContext& m_Context;
+    BYTE m_BGLine[SCREEN_PIXELS_WIDTH];     // BG/window colour indices of the line; sprite priority reads it
+};
+
+// Models the DMG pixel pipeline one dot at a time: the BG/window fetcher
+// (tile number, low and high plane, push into an empty FIFO), the discarded
+// SCX & 7 pixels, the fetcher restart when the window starts, and object
+// fetches that stall output. Mode 3 length therefore depends on SCX, the
+// window and the sprites on the line, and register writes take effect at the
+// dot they happen on.
+class FifoEngine : public PPUEngine {
+public:
+    explicit FifoEngine(const PPURenderContext& context);
+
+    PPUEngineKind kind() const override { return PPUEngineKind::FIFO; }
+    int transferCycles(int line) override;
+    void beginLine(int line) override;
+    void advance(int dots) override;
+    void endLine() override;
+
+private:
+    struct LineState {
+        int line;
+        int dot;                        // Cycles into mode 3
+        int x;                          // Next screen pixel
+        int discard;                    // SCX & 7 pixels still to drop
+        BYTE sprites[MAX_SPRITES_PER_LINE];
+        int spriteCount;
+        int nextSprite;                 // First sprite of the line not fetched yet
+        int spriteFetch;                // Dots left of the object fetch in progress
+        int fetchStep;                  // BG/window fetcher: <0 first (discarded) fetch, 0-5 fetching, 6 waiting to push
+        int fetchX;                     // Tile column the fetcher is on
+        BYTE tileEntry;                 // Tile map entry read at step 0
+        BYTE fetched[TILE_WIDTH];       // Colour indices read at step 4
+        bool inWindow;
+        int windowLine;                 // Window row this line draws
+        BYTE bg[TILE_WIDTH];            // BG FIFO, head first
+        int bgHead;
+        int bgCount;
+        BYTE objColor[TILE_WIDTH];      // OBJ FIFO, head first; colour 0 = transparent
+        BYTE objAttributes[TILE_WIDTH];
+        int objCount;
+    };
+
+    void startLine(LineState& state, int line) const;
+    void step(LineState& state, bool draw) const;
+    void tickFetcher(LineState& state) const;
+    void loadSprite(LineState& state, BYTE sprite) const;
+    void runTo(int dots);
+
+    const PPURenderContext& m_Context;
+    LineState m_Line;
+    bool m_Drawing;
+    bool m_WindowYHit;                  // WY matched LY on some line of this frame
+    int m_WindowLine;                   // Window rows drawn so far this frame
+    bool m_WindowUsed;                  // The line being transferred shows the window
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include "common.h"
+#include "ppu_engine.h"
+#include "thread_placement.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Scanline rendering on a helper thread. The emulation thread queues what it
+// would have drawn - each line's LCD register and palette snapshot - together
+// with every VRAM and OAM change in between, and the worker replays them in
+// order against its own copy of VRAM and OAM. Lines therefore come out exactly
+// as the inline ScanlineEngine would have drawn them, at most a frame later.
+class PPUWorker {
+public:
+    // After each drawn line: the line, its shades and the frame number it
+    // belongs to (for change tracking). Runs on the worker.
+    using LineDone = std::function<void(int line, const BYTE* shades, uint32_t frame)>;
+    // After the last line of a frame: publishes it and returns the buffer to
+    // draw the next frame into. Runs on the worker.
+    using FrameDone = std::function<BYTE*(uint32_t sequence)>;
+
+    PPUWorker(ByteSpan vram, ByteSpan oam, const PixelKernels& kernels, const ThreadPlacementConfig& placement,
+              BYTE* frame, LineDone lineDone, FrameDone frameDone);
+    ~PPUWorker();
+
+    // Emulation thread only:
+    void onVRAMWrite(WORD address);                 // After the write
+    void onOAMWrite() { m_OAMChanged = true; }      // Sent as a diff with the next line
+    void drawLine(int line, uint32_t frame, ByteSpan lcdRegisters, const BYTE* bgShades, const BYTE (*objShades)[4]);
+    void publishFrame(uint32_t sequence);
+    // Waits until everything queued has been drawn. Afterwards, until the
+    // next queued line, the worker touches nothing and the frame buffers
+    // can be used from the calling thread.
+    void sync();
+    // sync(), then copies VRAM and OAM again (state load, reset) and draws
+    // from now on into `frame`
+    void reload(BYTE* frame);
+
+private:
+    enum CommandKind : BYTE { VRAM_WRITE, OAM_WRITE, DRAW_LINE, PUBLISH };
+    struct Command {
+        BYTE kind;
+        BYTE value;                     // VRAM_WRITE, OAM_WRITE: the byte; DRAW_LINE: the line
+        WORD offset;                    // Into VRAM or OAM
+        uint32_t frame;                 // DRAW_LINE: frame number; PUBLISH: sequence
+        BYTE registers[LCD_REGISTER_COUNT];
+        BYTE bgShades[4];
+        BYTE objShades[2][4];
+    };
+    static constexpr uint32_t QUEUE_SIZE = 1 << 15;    // Commands; a power of two
+
+    void push(const Command& command);
+    void flush();                       // Makes pushed commands visible to the worker
+    void sendOAMChanges();
+    void run();
+    void execute(const Command& command);
+
+    // Worker side: copies of VRAM and OAM and an engine drawing from them
+    std::vector<BYTE> m_VRAM;
+    std::vector<BYTE> m_OAM;
+    BYTE m_Registers[LCD_REGISTER_COUNT];
+    BYTE m_BGShades[4];
+    BYTE m_OBJShades[2][4];
+    TileCache m_TileCache;
+    SpriteLines m_SpriteLines;
+    PPURenderContext m_Context;
+    ScanlineEngine m_Engine;
+    LineDone m_LineDone;
+    FrameDone m_FrameDone;
+
+    // Emulation side
+    ByteSpan m_SourceVRAM;
+    ByteSpan m_SourceOAM;
+    std::vector<BYTE> m_SentOAM;        // OAM as the worker will see it
+    bool m_OAMChanged;
+    uint32_t m_WriteIndex;              // Commands pushed, published or not
+    uint32_t m_CachedHead;              // Last m_Head seen; re-read only when the queue looks full
+
+    std::vector<Command> m_Queue;
+    alignas(64) std::atomic<uint32_t> m_Tail{0};       // Commands published to the worker
+    alignas(64) std::atomic<uint32_t> m_Head{0};       // Commands the worker has finished
+    std::atomic<bool> m_Sleeping{false};
+    std::atomic<bool> m_Stop{false};
+    std::mutex m_WakeMutex;
+    std::condition_variable m_Wake;
+    ThreadPlacementConfig m_Placement;
+    std::thread m_Thread;
+};
@@ -1,13 +1,19 @@
 #pragma once 
 #include <common.h>
+#include <machine_state.h>
 
-#define RAM_SIZE 0x10000  // 64KB of RAM
+// Address-decoding view over the internal memories held in a MachineState
+// (VRAM, WRAM, OAM, IO, HRAM, IE). Owns no storage of its own.
 class RAM{
     private:
-        BYTE m_memory [RAM_SIZE];
+        MachineState& m_State;
     public:
-        RAM();
+        explicit RAM(MachineState& state);
         ~RAM();
         BYTE read(WORD address) const;
         void write(WORD address,BYTE data);
-};
\ No newline at end of file
+        // Pointer to the backing byte for an address, or nullptr for the ROM
+        // window, external RAM and the restricted area
+        BYTE* locate(WORD address);
+        const BYTE* locate(WORD address) const;
+};
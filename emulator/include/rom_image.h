@@ -0,0 +1,59 @@
+#pragma once
+#include "common.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Immutable ROM contents, shared by every Cart in the process that loaded the
+// same bytes. Backed by a read-only file mapping when the platform allows it.
+class RomImage {
+public:
+    ~RomImage();
+
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    const BYTE* data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+    uint64_t hash() const { return m_Hash; }
+    bool isMapped() const { return m_Mapping != nullptr; }
+    BYTE operator[](size_t offset) const { return m_Data[offset]; }
+
+private:
+    friend class RomImageRegistry;
+    RomImage() = default;
+
+    const BYTE* m_Data = nullptr;
+    size_t m_Size = 0;
+    uint64_t m_Hash = 0;
+    void* m_Mapping = nullptr;    // Base of the read-only mapping, if any
+    std::vector<BYTE> m_Storage;  // Fallback when the file could not be mapped
+};
+
+// Process-wide registry handing out one RomImage per distinct ROM content.
+// Images are held weakly, so they are released when the last Cart lets go.
+class RomImageRegistry {
+public:
+    static RomImageRegistry& getInstance();
+
+    // Loads (or reuses) the image for the given file. Returns nullptr on failure.
+    std::shared_ptr<const RomImage> acquire(const std::string& filename);
+
+    size_t imageCount();      // Live, distinct images
+    size_t residentBytes();   // Bytes held by live images, counted once each
+
+    RomImageRegistry(const RomImageRegistry&) = delete;
+    RomImageRegistry& operator=(const RomImageRegistry&) = delete;
+
+private:
+    RomImageRegistry() = default;
+
+    static uint64_t hashContents(const BYTE* data, size_t size);
+    static std::unique_ptr<RomImage> loadImage(const std::string& filename);
+    void purgeExpired();
+
+    std::mutex m_Mutex;
+    std::unordered_map<uint64_t, std::weak_ptr<const RomImage>> m_Images;
+};
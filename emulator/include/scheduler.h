@@ -0,0 +1,46 @@
+#pragma once
+#include "common.h"
+#include <machine_state.h>
+#include <functional>
+
+// Central event scheduler. Peripherals post absolute deadlines (in T-cycles
+// on the 64-bit master clock) instead of being polled after every
+// instruction; the CPU runs until the earliest deadline and only the due
+// event's handler is called.
+//
+// The clock and deadlines live in the MachineState block, so a saved state
+// carries its pending events with it. Handlers are bound by the owning
+// components and are not part of the state.
+class Scheduler {
+public:
+    // Called with the cycle the event was due on (the clock may be slightly
+    // past it). Reschedule relative to that value to avoid drift.
+    using Handler = std::function<void(uint64_t deadline)>;
+
+    explicit Scheduler(SchedulerState& state);
+
+    void setHandler(SchedulerEvent event, Handler handler);
+
+    uint64_t now() const { return m_State.now; }
+    uint64_t nextDeadline() const { return m_State.nextDeadline; }
+    bool hasDueEvents() const { return m_State.now >= m_State.nextDeadline; }
+
+    void advance(int cycles) { m_State.now += static_cast<uint64_t>(cycles); }
+
+    void scheduleAt(SchedulerEvent event, uint64_t cycle);
+    void scheduleIn(SchedulerEvent event, uint64_t cycles) { scheduleAt(event, m_State.now + cycles); }
+    void cancel(SchedulerEvent event);
+    bool isScheduled(SchedulerEvent event) const { return deadline(event) != NO_DEADLINE; }
+    uint64_t deadline(SchedulerEvent event) const { return m_State.deadlines[static_cast<int>(event)]; }
+
+    // Runs the handlers of every event whose deadline has passed, earliest first
+    void runDueEvents();
+
+    void reset();  // Clock to 0, nothing scheduled
+
+private:
+    void updateNextDeadline();
+
+    SchedulerState& m_State;
+    Handler m_Handlers[SCHEDULER_EVENT_COUNT];
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "common.h"
+#include "byte_span.h"
+
+constexpr int MAX_SPRITES_PER_LINE = 10;   // DMG OAM scan limit
+
+// Sprites that overlap one scanline, highest priority first
+struct SpriteLine {
+    BYTE count;
+    BYTE sprites[MAX_SPRITES_PER_LINE];     // OAM indices 0-39
+};
+
+// Per-line sprite lists for a whole frame, built by one pass over OAM. An OAM
+// write or DMA only marks the lists stale; they are rebuilt the next time a
+// line needs them, so a frame that leaves OAM alone scans it once.
+class SpriteLines {
+public:
+    explicit SpriteLines(ByteSpan oam);     // 0xFE00-0xFE9F
+
+    // Sprites on visible line y for the given OBJ height (8 or 16). Like the
+    // DMG, the first ten overlapping sprites in OAM order are selected, then
+    // ordered by X with the lower OAM index winning ties.
+    const SpriteLine& line(int y, int spriteHeight) {
+        if (m_Dirty || spriteHeight != m_Height) {
+            rebuild(spriteHeight);
+        }
+        return m_Lines[y];
+    }
+
+    // Called after OAM changed (CPU write, DMA, state load)
+    void invalidate() { m_Dirty = true; }
+
+private:
+    void rebuild(int spriteHeight);
+
+    const BYTE* m_OAM;
+    bool m_Dirty;
+    int m_Height;
+    SpriteLine m_Lines[VISIBLE_SCANLINES];
+};
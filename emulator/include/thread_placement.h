@@ -0,0 +1,85 @@
+#pragma once
+#include "common.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Host scheduling controls for the emulator's threads. Everything here is
+// best effort: a platform or privilege that does not allow a setting logs a
+// warning and leaves the thread as the OS placed it.
+enum class ThreadRole : BYTE {
+    EMULATION,                  // Runs the guest (Emulator::emulationLoop)
+    RENDER,                     // SDL events and presentation (Emulator::run)
+    WORKER                      // Helper threads
+};
+
+// Whether scanline rendering runs on a worker thread (PPUWorker)
+enum class PPUThreadMode : BYTE {
+    AUTO,                       // When a worker CPU set is configured
+    ON,
+    OFF
+};
+
+struct ThreadPlacementConfig {
+    std::vector<int> emulationCpus;     // Empty: let the OS place the thread
+    std::vector<int> renderCpus;
+    std::vector<int> workerCpus;
+    bool realtime = false;              // SCHED_FIFO for the emulation thread
+    int realtimePriority = 10;          // 1-99
+    bool lockMemory = false;            // mlockall while emulation runs
+    PPUThreadMode ppuThread = PPUThreadMode::AUTO;
+};
+
+constexpr const char* THREAD_CONFIG_FILE = "threads.cfg";
+
+// Each non-comment line is "<setting> = <value>":
+//   emulation = 2        render = 0,1        worker = 3-5
+//   realtime = on|off|<priority 1-99>        mlock = on|off
+//   ppu_thread = on|off|auto
+// A missing file gives the defaults above (no pinning, nothing privileged).
+ThreadPlacementConfig loadThreadPlacementConfig(const std::string& path);
+
+// Resolves PPUThreadMode::AUTO for this host
+bool usePPUThread(const ThreadPlacementConfig& config);
+
+// Applies the role's CPU set and, for EMULATION, the real-time policy to the
+// calling thread. Returns false if any requested setting was refused.
+bool placeCurrentThread(const ThreadPlacementConfig& config, ThreadRole role);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE), falling back to MCL_CURRENT when the
+// locked-memory limit is too low for future mappings
+bool lockProcessMemory();
+void unlockProcessMemory();
+
+struct ThreadSchedReport {
+    bool available;                     // False where the host exposes no counters
+    double contextSwitchesPerMin;       // Voluntary + involuntary
+    double involuntarySwitchesPerMin;   // Preempted while runnable - the ones that cost frames
+    double migrationsPerMin;            // Moved to another CPU
+};
+
+// Per-thread context switch and migration rates. restart() and sample() must
+// be called on the thread being measured; report() from any thread.
+class ThreadSchedMonitor {
+public:
+    ThreadSchedMonitor();
+
+    void restart();
+    // Returns true when a new one-minute window was completed
+    bool sample();
+    ThreadSchedReport report() const;
+
+private:
+    struct Counters {
+        bool valid;
+        uint64_t voluntary;
+        uint64_t involuntary;
+        uint64_t migrations;
+    };
+    static Counters readCounters();
+
+    Counters m_Start;
+    int64_t m_StartNs;
+    ThreadSchedReport m_Report;
+    mutable std::mutex m_ReportMutex;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "common.h"
+#include "pixel_kernels.h"
+#include "byte_span.h"
+
+constexpr int TILE_COUNT = 384;             // Tiles in 0x8000-0x97FF
+constexpr int TILE_BANKS = 1;               // DMG has one VRAM bank; CGB bank 1 would be tiles 384-767
+
+// All VRAM tiles pre-decoded to 8x8 arrays of 2-bit colour indices, one byte
+// per pixel. A VRAM write only marks the tile it lands in dirty; the tile is
+// decoded again the next time a scanline uses it, so a line is drawn by
+// copying 8-pixel rows.
+class TileCache {
+public:
+    explicit TileCache(ByteSpan vram);      // 0x8000-0x9FFF of bank 0
+
+    // Colour indices of row y (0-7) of tile 0-383, leftmost pixel first
+    const BYTE* row(int tile, int y) {
+        if (m_Dirty[tile]) {
+            decode(tile);
+        }
+        return m_Tiles[tile][y];
+    }
+
+    // Tile number of a tile map entry: 0x8000 addressing is unsigned, 0x8800
+    // addressing is signed relative to tile 256 (0x9000)
+    static int tileNumber(BYTE mapEntry, bool unsignedIndexing) {
+        return unsignedIndexing ? mapEntry : 256 + static_cast<int8_t>(mapEntry);
+    }
+
+    // Called after a VRAM write; tile map writes are ignored
+    void invalidate(WORD address) {
+        WORD offset = static_cast<WORD>(address - 0x8000);
+        if (offset < TILE_COUNT * TILE_SIZE) {
+            m_Dirty[offset / TILE_SIZE] = true;
+        }
+    }
+    // After VRAM changed wholesale (state load, reset)
+    void invalidateAll();
+
+private:
+    void decode(int tile);
+
+    const BYTE* m_VRAM;
+    const PixelKernels& m_Kernels;
+    BYTE m_Tiles[TILE_COUNT * TILE_BANKS][TILE_HEIGHT][TILE_WIDTH];
+    bool m_Dirty[TILE_COUNT * TILE_BANKS];
+};
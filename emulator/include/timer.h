@@ -18,31 +18,40 @@ namespace GB {
 class Timer {
 private:
     std::shared_ptr<MemoryController> memoryController;
-    BYTE m_Counter;     // TIMA - Timer counter
-    BYTE m_Modulo;      // TMA - Timer modulo
-    BYTE m_Control;     // TMC - Timer control
-    int m_TimerCounter; // Internal counter for frequency tracking
-    bool m_IsEnabled;   // Timer enabled flag
-    int m_DividerCounter;    // Counter for divider register
-    BYTE m_DividerRegister;  // Current value of divider register
+    Scheduler& m_Scheduler;
+    // DIV and TIMA are computed from cycle timestamps when read; only the
+    // next TIMA overflow is scheduled. Nothing runs per instruction.
+    TimerState& m_State;      // divBase / timaBase / timaValue
+    BYTE& m_Modulo;           // TMA - Timer modulo
+    BYTE& m_Control;          // TMC - Timer control
 
 public:
     Timer(std::shared_ptr<MemoryController> memory);
+    ~Timer();
     bool isEnabled() const;
-    void update(int cycles);
     BYTE read(WORD address) const;
     void write(WORD address, BYTE value);
     bool isInterruptRequested() const;
     void resetInterruptRequest();
-    void updateDividerRegister(int cycles);
     BYTE getDividerRegister() const;
     void resetDividerRegister();
     void reset();
 
 private:
+    // Scheduler event handler
+    void onOverflow(uint64_t deadline);
+
+    // Lazy evaluation helpers
+    uint64_t systemCounter() const;       // T-cycles since the last DIV reset
+    BYTE currentTIMA() const;
+    void materializeTIMA();               // Fold elapsed increments into timaValue
+    void incrementTIMA();                 // Single increment (falling-edge glitch)
+    void scheduleOverflow();
+
     int getFrequency() const;
     BYTE getClockFreq() const;
     void setClockFreq();
     int getFrequencyPeriod() const;
+    static int getFrequencyPeriod(BYTE control);
 };
 } // namespace GB
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of whole frames from one producer thread to one consumer
+// thread. Of the three slots the producer owns one (back), the consumer owns
+// one (front) and the third (middle) is swapped atomically: the producer
+// publishes by trading its finished back slot for the middle one, and the
+// consumer picks up the newest frame by trading its front slot for the middle
+// one. Neither side blocks, and neither can see a slot the other is writing.
+template <typename Slot>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const Slot& initial)
+        : m_Slots{ initial, initial, initial }
+        , m_Back(0)
+        , m_Published(1)
+        , m_Middle(1)
+        , m_Front(2)
+    {
+    }
+
+    // Producer: the slot being filled
+    Slot& back() { return m_Slots[m_Back]; }
+    // Producer: the slot published last. The consumer may be reading it, but
+    // nothing writes it before the producer's next publish.
+    const Slot& published() const { return m_Slots[m_Published]; }
+    // Producer: hands the back slot over and takes a free one to fill next
+    void publish() {
+        m_Published = m_Back;
+        m_Back = m_Middle.exchange(m_Back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Consumer: moves to the newest published slot; false when nothing was
+    // published since the last call
+    bool acquire() {
+        if (!(m_Middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    // Consumer: the slot taken by the last successful acquire
+    const Slot& front() const { return m_Slots[m_Front]; }
+
+private:
+    static constexpr uint32_t INDEX = 0x03;
+    static constexpr uint32_t FRESH = 0x04;    // Middle holds a slot the consumer has not taken
+
+    Slot m_Slots[3];
+    uint32_t m_Back;                            // Producer thread only
+    uint32_t m_Published;                       // Producer thread only
+    alignas(64) std::atomic<uint32_t> m_Middle; // Own cache line; the only shared word
+    alignas(64) uint32_t m_Front;               // Consumer thread only
+};
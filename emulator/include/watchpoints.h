@@ -0,0 +1,75 @@
+#pragma once
+#include "common.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Watchpoint kinds - may be OR'ed together
+constexpr BYTE WATCH_READ    = 0x01;
+constexpr BYTE WATCH_WRITE   = 0x02;
+constexpr BYTE WATCH_EXECUTE = 0x04;
+
+constexpr int WATCH_PAGE_SHIFT = 8;   // 256-byte pages
+constexpr int WATCH_PAGE_COUNT = 0x10000 >> WATCH_PAGE_SHIFT;
+
+struct Watchpoint {
+    int id;
+    WORD start;                 // Inclusive range
+    WORD end;
+    BYTE types;                 // WATCH_* mask
+};
+
+struct WatchHit {
+    int id;                     // Watchpoint that fired
+    BYTE type;                  // WATCH_READ, WATCH_WRITE or WATCH_EXECUTE
+    WORD address;
+    WORD pc;                    // Address of the instruction that caused the access
+    BYTE oldValue;              // Value before the access (== newValue for reads/execute)
+    BYTE newValue;              // Value after the access
+};
+
+// Read/write/execute watchpoints for the CPU bus.
+// Every 256-byte page has a flag byte holding the union of the watch kinds set
+// on it. The bus only enters the checking slow path when the page flag for the
+// access kind is set, so pages without watchpoints keep their fast path.
+class Watchpoints {
+public:
+    Watchpoints();
+
+    // Returns the watchpoint id, or -1 if the range/types are invalid
+    int add(WORD start, WORD end, BYTE types);
+    bool remove(int id);
+    void clear();
+    std::vector<Watchpoint> list() const;
+
+    // Route every page through the slow path (used by the access profiler)
+    void setInstrumentAll(bool enabled);
+
+    // Fast-path test: is any watchpoint of this kind set on the address's page?
+    bool isPageWatched(WORD address, BYTE type) const {
+        return (m_PageFlags[address >> WATCH_PAGE_SHIFT].load(std::memory_order_relaxed) & type) != 0;
+    }
+
+    // Slow path: exact range test, records the first hit until it is taken.
+    // Returns true if the access hit a watchpoint.
+    bool check(WORD address, BYTE type, WORD pc, BYTE oldValue, BYTE newValue);
+
+    bool hasHit() const { return m_HitPending.load(std::memory_order_acquire); }
+    WatchHit takeHit();
+
+    static std::string describe(const WatchHit& hit);
+
+private:
+    void rebuildPageFlags();  // Caller holds m_Mutex
+
+    std::array<std::atomic<BYTE>, WATCH_PAGE_COUNT> m_PageFlags;
+    std::vector<Watchpoint> m_Watchpoints;
+    std::atomic<bool> m_HasWatchpoints;  // Lets check() skip the lock when only instrumenting
+    bool m_InstrumentAll;
+    int m_NextId;
+    WatchHit m_Hit;
+    std::atomic<bool> m_HitPending;
+    mutable std::mutex m_Mutex;  // Guards the list and m_Hit (debugger thread vs emulation thread)
+};
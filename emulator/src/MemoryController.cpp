@@ -1,18 +1,29 @@
 #include "memory_controller.h"
+#include <ppu.h>
+#include <timer.h>
 #include <sstream>
 #include <iomanip>
 
 MemoryController::MemoryController()
-    : m_EnableRAM(false)
-    , m_ROMBanking(true)
+    : m_State(std::make_unique<MachineState>())  // Value-initialised: every byte, padding included, is zero
+    , m_Rom(nullptr)
+    , emulator(nullptr)
+    , m_Timer(nullptr)
+    , m_PPU(nullptr)
     , m_MBC1(false)
     , m_MBC2(false)
-    , m_CurrentROMBank(1)
-    , m_CurrentRAMBank(0)
+    , m_InstructionPC(0)
+    , m_ResumingExecuteHit(false)
+    , m_ExecuteHitPC(0)
 {
-    ram = std::make_unique<RAM>();
-    m_RAMBanks.resize(0x8000);  // 32KB of RAM banks
-    LOG_INFO("Memory Controller initialized");
+    ram = std::make_unique<RAM>(*m_State);
+    m_Scheduler = std::make_unique<Scheduler>(m_State->scheduler);
+    m_Scheduler->setHandler(SchedulerEvent::DMA_COMPLETE, [this](uint64_t deadline) { onDMAComplete(deadline); });
+    m_Scheduler->setHandler(SchedulerEvent::SERIAL_SHIFT, [this](uint64_t deadline) { onSerialShift(deadline); });
+    m_State->mbc.romBank = 1;
+    m_State->mbc.romBankingMode = true;
+    LOG_INFO("Memory Controller initialized (machine state block: " +
+             std::to_string(MACHINE_STATE_SIZE) + " bytes)");
 }
 void MemoryController::RequestInterrupt(BYTE interrupt) {
     if (emulator) {
@@ -33,38 +44,50 @@ BYTE MemoryController::read(WORD address) const {
     switch (region) {
         case MemoryRegion::JOYPAD_REGISTER:
         {
-            // Handle joypad register read
-            BYTE joypadRequest = read(JOYPAD_REGISTER);
-            return (joypadRequest & UPPER_NIBBLE_MASK) | emulator->joypad.GetState(joypadRequest);
+            // Composed from the live button state at the moment the guest reads it
+            BYTE joypadRequest = ram->read(JOYPAD_REGISTER);
+            BYTE keys = emulator ? emulator->joypad.GetState(joypadRequest) : 0x0F;
+            return (joypadRequest & UPPER_NIBBLE_MASK) | keys;
         }
         case MemoryRegion::ROM_BANK_0:
-            LOG_DEBUG("MemoryController::read - In ROM_BANK_0 for address 0x" + std::to_string(address)); // Add this
-            if (cart && cart->isLoaded()) {
-                BYTE cartValue = cart->read(address);
-                LOG_DEBUG("MemoryController::read - Cart valid and loaded. cart->read returned 0x" + std::to_string(cartValue)); // Add this
-                return cartValue;
-            } else {
-                LOG_ERROR("MemoryController::read - Cart is NULL or not loaded for ROM_BANK_0 read at 0x" + std::to_string(address)); // Add this
+            if (m_Rom && address < m_Rom->size()) {
+                return (*m_Rom)[address];
+            }
+            if (!m_Rom) {
+                LOG_ERROR("MemoryController::read - Cart is NULL or not loaded for ROM_BANK_0 read at 0x" + std::to_string(address));
             }
             break;
 
         case MemoryRegion::ROM_BANK_N:
-            if (cart && cart->isLoaded()) {
-                WORD newAddress = address - 0x4000;
-                return cart->read(newAddress + (m_CurrentROMBank * 0x4000));
+            if (m_Rom) {
+                size_t romAddress = (address - 0x4000) + (static_cast<size_t>(m_State->mbc.romBank) * 0x4000);
+                if (romAddress < m_Rom->size()) {
+                    return (*m_Rom)[romAddress];
+                }
             }
             break;
 
         case MemoryRegion::EXTERNAL_RAM:
-            if (m_EnableRAM) {
+            if (m_State->mbc.ramEnabled) {
                 WORD newAddress = address - 0xA000;
-                return m_RAMBanks[newAddress + (m_CurrentRAMBank * 0x2000)];
+                return m_State->externalRAM[newAddress + (m_State->mbc.ramBank * 0x2000)];
             }
             break;
 
         case MemoryRegion::ECHO_RAM:
             return ram->read(address - 0x2000);
 
+        case MemoryRegion::IO_PORTS:
+            // DIV and TIMA are computed on demand from the scheduler clock
+            if (m_Timer && (address == DIV_REGISTER || address == TIMA)) {
+                return m_Timer->read(address);
+            }
+            // LY and STAT are only current once the lazy PPU has caught up
+            if (m_PPU && address >= LCD_CONTROL && address <= LCD_REGISTERS_END) {
+                m_PPU->catchUp();
+            }
+            return ram->read(address);
+
         case MemoryRegion::RESTRICTED:
             LOG_WARNING("Read attempt from restricted memory area: 0x" + 
                        std::to_string(address));
@@ -93,62 +116,286 @@ void MemoryController::DoRamBankEnable(WORD address, BYTE data) {
     // Check lower nibble for both MBC1 and MBC2
     BYTE testData = data & LOWER_NIBBLE_MASK;
     if (testData == 0x0A) {
-        m_EnableRAM = true;
+        m_State->mbc.ramEnabled = true;
     } else if (testData == 0x00) {
-        m_EnableRAM = false;
+        m_State->mbc.ramEnabled = false;
     }
 
-    LOG_DEBUG("RAM bank " + std::string(m_EnableRAM ? "enabled" : "disabled") + 
+    LOG_DEBUG("RAM bank " + std::string(m_State->mbc.ramEnabled ? "enabled" : "disabled") + 
               " (MBC" + std::string(m_MBC2 ? "2" : "1") + ")");
 }
 
 void MemoryController::DoChangeLoROMBank(BYTE data) {
     // MBC2 handling - only uses lower 4 bits
     if (m_MBC2) {
-        m_CurrentROMBank = data & LOWER_NIBBLE_MASK;
-        if (m_CurrentROMBank == 0) {
-            m_CurrentROMBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
+        m_State->mbc.romBank = data & LOWER_NIBBLE_MASK;
+        if (m_State->mbc.romBank == 0) {
+            m_State->mbc.romBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
         }
-        LOG_DEBUG("MBC2 ROM bank changed to " + std::to_string(m_CurrentROMBank));
+        LOG_DEBUG("MBC2 ROM bank changed to " + std::to_string(m_State->mbc.romBank));
         return;
     }
 
     // MBC1 handling - uses lower 5 bits
     BYTE lower5 = data & 0x1F;           // 0x1F = 31 = 0b00011111
-    m_CurrentROMBank &= 0xE0;           // 0xE0 = 224 = 0b11100000
-    m_CurrentROMBank |= lower5;
+    m_State->mbc.romBank &= 0xE0;           // 0xE0 = 224 = 0b11100000
+    m_State->mbc.romBank |= lower5;
 
-    if (m_CurrentROMBank == 0) {
-        m_CurrentROMBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
+    if (m_State->mbc.romBank == 0) {
+        m_State->mbc.romBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
     }
     
-    LOG_DEBUG("MBC1 ROM bank lower bits changed to " + std::to_string(m_CurrentROMBank));
+    LOG_DEBUG("MBC1 ROM bank lower bits changed to " + std::to_string(m_State->mbc.romBank));
 }
 void MemoryController::doDMATransfer(BYTE data) {
     WORD sourceAddress = data << 8;  // Multiply by 0x100 (256)
-    
-    // Copy 160 bytes from source to OAM
-    for (BYTE i = 0; i < DMA_LENGTH; i++) {
-        BYTE value = read(sourceAddress + i);
-        write(OAM_START + i, value);
+    // On DMG, source pages 0xE0-0xFF read the work RAM mirror
+    if (sourceAddress >= 0xE000) {
+        sourceAddress -= 0x2000;
     }
-    
-    LOG_DEBUG("DMA Transfer from 0x" + 
-              std::to_string(sourceAddress) + 
-              " to OAM complete");
+
+    // The 160 bytes land in OAM immediately; the CPU can't observe OAM until the
+    // transfer ends anyway, so only the bus lock needs to last the full 640 cycles
+    BYTE* oam = m_State->oam;
+    const BYTE* source = resolveDMASource(sourceAddress);
+    if (source) {
+        memcpy(oam, source, DMA_LENGTH);
+    } else {
+        // Banked ROM or disabled cart RAM - go through the mapper
+        for (BYTE i = 0; i < DMA_LENGTH; i++) {
+            oam[i] = read(sourceAddress + i);
+        }
+    }
+    if (m_PPU) {
+        m_PPU->onOAMWrite();
+    }
+
+    m_State->dma.source = sourceAddress;
+    m_State->dma.startCycle = m_Scheduler->now();
+    m_State->dma.active = true;
+    m_Scheduler->scheduleIn(SchedulerEvent::DMA_COMPLETE, DMA_DURATION_CYCLES);
+}
+
+void MemoryController::onDMAComplete(uint64_t /*deadline*/) {
+    m_State->dma.active = false;
+}
+
+// Returns a pointer to the source page when it is plain memory, nullptr otherwise
+const BYTE* MemoryController::resolveDMASource(WORD sourceAddress) const {
+    switch (getMemoryRegion(sourceAddress)) {
+        case MemoryRegion::VRAM:
+        case MemoryRegion::WORK_RAM:
+            return ram->locate(sourceAddress);
+        case MemoryRegion::EXTERNAL_RAM:
+            if (m_State->mbc.ramEnabled) {
+                return m_State->externalRAM + (sourceAddress - 0xA000) + (m_State->mbc.ramBank * 0x2000);
+            }
+            return nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+// The mode has to be current, so the lazy PPU catches up first - only when a
+// mode boundary has passed, which keeps copy loops off the catch-up path.
+// With the LCD off the PPU sits in mode 0 and both buses are open.
+bool MemoryController::isLockedByPPU(WORD address) const {
+    if (!m_PPU) {
+        return false;
+    }
+    if (!m_PPU->isModeCurrent()) {
+        m_PPU->catchUp();
+    }
+    BYTE mode = m_State->ppu.mode;
+    if (address >= OAM_START) {
+        return mode == MODE_OAM || mode == MODE_TRANSFER;
+    }
+    return mode == MODE_TRANSFER;
+}
+
+// While OAM DMA runs the CPU keeps the internal bus (IO, HRAM, IE). OAM itself is
+// unavailable, and so is whichever bus - VRAM or external - the DMA is reading from.
+bool MemoryController::isLockedDuringDMA(WORD address) const {
+    if (address >= 0xFF00) {
+        return false;
+    }
+    if (address >= OAM_START) {
+        return true;
+    }
+    bool addressOnVRAMBus = (address >= 0x8000 && address <= 0x9FFF);
+    bool sourceOnVRAMBus = (m_State->dma.source >= 0x8000 && m_State->dma.source <= 0x9FFF);
+    return addressOnVRAMBus == sourceOnVRAMBus;
+}
+
+BYTE MemoryController::readDuringDMA(WORD address) const {
+    if (!isLockedDuringDMA(address)) {
+        return read(address);
+    }
+    if (address >= OAM_START) {
+        return BYTE_MASK;
+    }
+    // A conflicting read sees the byte the DMA is moving on this M-cycle
+    int index = static_cast<int>((m_Scheduler->now() - m_State->dma.startCycle) / 4);
+    if (index >= DMA_LENGTH) {
+        index = DMA_LENGTH - 1;
+    }
+    return m_State->oam[index];
+}
+// IO writes: registers that drive scheduled events hand the write to their owner
+void MemoryController::writeIO(WORD address, BYTE data) {
+    if (m_PPU && address >= LCD_CONTROL && address <= LCD_REGISTERS_END) {
+        m_PPU->catchUp();  // Lines before this write render with the old value
+    }
+    switch (address) {
+        case DIV_REGISTER:
+        case TIMA:
+        case TMA:
+        case TMC:
+            if (m_Timer) {
+                m_Timer->write(address, data);
+                return;
+            }
+            break;
+
+        case LCD_CONTROL: {
+            BYTE previous = ram->read(LCD_CONTROL);
+            ram->write(LCD_CONTROL, data);
+            if (m_PPU) {
+                m_PPU->onLCDControlWrite(previous, data);
+            }
+            return;
+        }
+
+        case STAT_REGISTER:
+            // Mode and LYC=LY bits are read-only
+            ram->write(address, (data & 0xF8) | (ram->read(address) & 0x07));
+            if (m_PPU) {
+                m_PPU->onStatusWrite();
+            }
+            return;
+
+        case LYC_REGISTER:
+            ram->write(address, data);
+            if (m_PPU) {
+                m_PPU->onStatusWrite();
+            }
+            return;
+
+        case LY_REGISTER:
+            return;  // Read-only
+
+        case BGP_REGISTER:
+        case OBP0_REGISTER:
+        case OBP1_REGISTER:
+            ram->write(address, data);
+            if (m_PPU) {
+                m_PPU->onPaletteWrite(address);
+            }
+            return;
+
+        case SERIAL_CONTROL:
+            ram->write(address, data);
+            if ((data & (SERIAL_START_BIT | SERIAL_INTERNAL_CLOCK)) == (SERIAL_START_BIT | SERIAL_INTERNAL_CLOCK)) {
+                // Internal clock: shift out 8 bits at 8192 Hz. With no link
+                // partner attached every bit shifted in is 1.
+                m_State->serial.bitsRemaining = 8;
+                m_Scheduler->scheduleIn(SchedulerEvent::SERIAL_SHIFT, SERIAL_BIT_CYCLES);
+            } else if (!(data & SERIAL_START_BIT)) {
+                m_State->serial.bitsRemaining = 0;
+                m_Scheduler->cancel(SchedulerEvent::SERIAL_SHIFT);
+            }
+            return;
+
+        default:
+            break;
+    }
+    ram->write(address, data);
+}
+
+void MemoryController::onSerialShift(uint64_t deadline) {
+    BYTE& sb = m_State->ioRegister(SERIAL_DATA);
+    sb = static_cast<BYTE>((sb << 1) | 0x01);
+    if (--m_State->serial.bitsRemaining > 0) {
+        m_Scheduler->scheduleAt(SchedulerEvent::SERIAL_SHIFT, deadline + SERIAL_BIT_CYCLES);
+        return;
+    }
+    m_State->ioRegister(SERIAL_CONTROL) &= ~SERIAL_START_BIT;
+    RequestInterrupt(SERIAL_INTERRUPT_BIT);
+}
+
+// Slow path for writes to a page with a write watchpoint. The values come
+// from the backing store: a bus read could have side effects (LY catch-up,
+// computed DIV/TIMA) and would show up in the profiler.
+void MemoryController::watchedWrite(WORD address, BYTE data) {
+    const BYTE* stored = backingByte(address);
+    BYTE oldValue = stored ? *stored : BYTE_MASK;
+    write(address, data);
+    instrumentedAccess(address, WATCH_WRITE, oldValue, stored ? *stored : BYTE_MASK);
+}
+
+// The byte behind an address as last stored, through the current ROM and RAM
+// banks; nullptr for the restricted area and unmapped ROM
+const BYTE* MemoryController::backingByte(WORD address) const {
+    if (address < 0x8000) {
+        size_t romAddress = address < 0x4000 ? address
+                                             : (address - 0x4000) + static_cast<size_t>(m_State->mbc.romBank) * 0x4000;
+        return m_Rom && romAddress < m_Rom->size() ? m_Rom->data() + romAddress : nullptr;
+    }
+    if (address >= 0xA000 && address < 0xC000) {
+        return &m_State->externalRAM[(address - 0xA000) + m_State->mbc.ramBank * 0x2000];
+    }
+    return ram->locate(address);
+}
+
+// Slow path for instruction starts on a page with an execute watchpoint
+bool MemoryController::watchedExecute(WORD pc, bool resuming) {
+    if (resuming && pc == m_ExecuteHitPC) {
+        return false;
+    }
+    BYTE opcode = read(pc);
+    return instrumentedAccess(pc, WATCH_EXECUTE, opcode, opcode);
 }
+
+// Slow path shared by watchpoints and the access profiler. Fetches are
+// counted in cpuFetch, so execute checks are not counted here.
+bool MemoryController::instrumentedAccess(WORD address, BYTE type, BYTE oldValue, BYTE newValue) const {
+    if (m_Profiler && type != WATCH_EXECUTE) {
+        m_Profiler->record(address, type == WATCH_READ ? ACCESS_READ : ACCESS_WRITE);
+    }
+    return m_Watchpoints.check(address, type, m_InstructionPC, oldValue, newValue);
+}
+
+WatchHit MemoryController::takeWatchHit() {
+    WatchHit hit = m_Watchpoints.takeHit();
+    if (hit.type == WATCH_EXECUTE) {
+        m_ResumingExecuteHit = true;
+        m_ExecuteHitPC = hit.pc;
+    }
+    return hit;
+}
+
+void MemoryController::startProfiler(std::unique_ptr<AccessProfiler> profiler) {
+    m_Profiler = std::move(profiler);
+    m_Watchpoints.setInstrumentAll(m_Profiler != nullptr);
+}
+
+std::unique_ptr<AccessProfiler> MemoryController::stopProfiler() {
+    m_Watchpoints.setInstrumentAll(false);
+    return std::move(m_Profiler);
+}
+
 void MemoryController::DoChangeHiRomBank(BYTE data) {
     // Clear upper 3 bits of current ROM bank (keep lower 5)
-    m_CurrentROMBank &= 0x1F;           // 0x1F = 31 = 0b00011111
+    m_State->mbc.romBank &= 0x1F;           // 0x1F = 31 = 0b00011111
     
     // Set upper bits from data (bits 5-6)
-    m_CurrentROMBank |= ((data & 0x03) << 5);  // Shift to bits 5-6 position
+    m_State->mbc.romBank |= ((data & 0x03) << 5);  // Shift to bits 5-6 position
     
-    if (m_CurrentROMBank == 0) {
-        m_CurrentROMBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
+    if (m_State->mbc.romBank == 0) {
+        m_State->mbc.romBank++;  // Bank 0 is fixed at 0x0000-0x3FFF
     }
     
-    LOG_DEBUG("MBC1 ROM bank high bits changed to " + std::to_string(m_CurrentROMBank));
+    LOG_DEBUG("MBC1 ROM bank high bits changed to " + std::to_string(m_State->mbc.romBank));
 }
 
 void MemoryController::DoRAMBankChange(BYTE data) {
@@ -157,20 +404,20 @@ void MemoryController::DoRAMBankChange(BYTE data) {
         return;  // MBC2 doesn't support RAM banking
     }
     
-    m_CurrentRAMBank = data & 0x03;  // Only lower 2 bits used
-    LOG_DEBUG("RAM bank changed to " + std::to_string(m_CurrentRAMBank));
+    m_State->mbc.ramBank = data & 0x03;  // Only lower 2 bits used
+    LOG_DEBUG("RAM bank changed to " + std::to_string(m_State->mbc.ramBank));
 }
 
 void MemoryController::DoChangeROMRAMMode(BYTE data) {
     bool newMode = (data & 0x01) == 0;
     
     // Only change mode if it's different
-    if (m_ROMBanking != newMode) {
-        m_ROMBanking = newMode;
+    if (m_State->mbc.romBankingMode != newMode) {
+        m_State->mbc.romBankingMode = newMode;
         
         // Reset RAM bank when switching to ROM banking mode
-        if (m_ROMBanking) {
-            m_CurrentRAMBank = 0;
+        if (m_State->mbc.romBankingMode) {
+            m_State->mbc.ramBank = 0;
             LOG_DEBUG("Switched to ROM banking mode, RAM bank reset to 0");
         } else {
             LOG_DEBUG("Switched to RAM banking mode");
@@ -197,9 +444,8 @@ void MemoryController::write(WORD address, BYTE data) {
     switch (region) {
         case MemoryRegion::JOYPAD_REGISTER:
         {
-            // Handle joypad register write
-            BYTE joypadRequest = read(JOYPAD_REGISTER);
-            ram->write(JOYPAD_REGISTER, joypadRequest & UPPER_NIBBLE_MASK);
+            // Only the select bits are writable; the low nibble is composed on read
+            ram->write(JOYPAD_REGISTER, data & UPPER_NIBBLE_MASK);
             break;
         }
             
@@ -207,19 +453,45 @@ void MemoryController::write(WORD address, BYTE data) {
         case MemoryRegion::ROM_BANK_N:
             HandleBanking(address, data);
             break;
+        case MemoryRegion::VRAM:
+            // Lines the PPU has not drawn yet must see the old contents
+            if (m_PPU) {
+                m_PPU->catchUp();
+            }
+            ram->write(address, data);
+            if (m_PPU) {
+                m_PPU->onVRAMWrite(address);
+            }
+            break;
+        case MemoryRegion::SPRITE_TABLE:
+            if (m_PPU) {
+                m_PPU->catchUp();
+            }
+            ram->write(address, data);
+            if (m_PPU) {
+                m_PPU->onOAMWrite();
+            }
+            break;
         case MemoryRegion::DMA_REGISTER:
+            if (m_PPU) {
+                m_PPU->catchUp();
+            }
+            ram->write(address, data);
             doDMATransfer(data);
             break;
         case MemoryRegion::EXTERNAL_RAM:
-            if (m_EnableRAM) {
+            if (m_State->mbc.ramEnabled) {
                 WORD newAddress = address - 0xA000;
-                m_RAMBanks[newAddress + (m_CurrentRAMBank * 0x2000)] = data;
+                m_State->externalRAM[newAddress + (m_State->mbc.ramBank * 0x2000)] = data;
             }
             break;
 
         case MemoryRegion::ECHO_RAM:
             ram->write(address - 0x2000, data);
-            ram->write(address, data);
+            break;
+
+        case MemoryRegion::IO_PORTS:
+            writeIO(address, data);
             break;
 
         case MemoryRegion::RESTRICTED:
@@ -246,7 +518,7 @@ void MemoryController::HandleBanking(WORD address, BYTE data) {
     }
     else if (address < 0x6000) {
         if (m_MBC1) {
-            if (m_ROMBanking) {
+            if (m_State->mbc.romBankingMode) {
                 DoChangeHiRomBank(data);
             } else {
                 DoRAMBankChange(data);
@@ -260,6 +532,13 @@ void MemoryController::HandleBanking(WORD address, BYTE data) {
     }
 }
 
+void MemoryController::loadState(const MachineState& in) {
+    memcpy(m_State.get(), &in, sizeof(MachineState));
+    if (m_PPU) {
+        m_PPU->onStateLoaded();
+    }
+}
+
 bool MemoryController::attachCart(std::unique_ptr<Cart> newCart) {
     if (cart) {
         LOG_WARNING("Attempting to attach cart while another is present");
@@ -267,6 +546,9 @@ bool MemoryController::attachCart(std::unique_ptr<Cart> newCart) {
     }
     
     cart = std::move(newCart);
+    m_Rom = cart->getRomImage().get();
+    // The cart's external RAM lives in the machine state block
+    cart->attachRAM(m_State->externalRAM, sizeof(m_State->externalRAM));
     
         // Set MBC type based on cartridge type
         BYTE cartType = cart->getCartridgeType();
@@ -285,9 +567,10 @@ bool MemoryController::detachCart() {
     }
     
     cart.reset();
-    m_EnableRAM = false;
-    m_CurrentROMBank = 1;
-    m_CurrentRAMBank = 0;
+    m_Rom = nullptr;
+    m_State->mbc.ramEnabled = false;
+    m_State->mbc.romBank = 1;
+    m_State->mbc.ramBank = 0;
     
     LOG_INFO("Cartridge detached from Memory Controller");
     return true;
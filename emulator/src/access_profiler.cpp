@@ -0,0 +1,140 @@
+#include <access_profiler.h>
+#include <logger.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+const char* const BANK_WRITE_NAMES[BANK_WRITE_KINDS] = {
+    "RAM_ENABLE",        // 0x0000-0x1FFF
+    "ROM_BANK_LOW",      // 0x2000-0x3FFF
+    "ROM_BANK_HIGH",     // 0x4000-0x5FFF (RAM bank in RAM banking mode)
+    "BANKING_MODE"       // 0x6000-0x7FFF
+};
+
+uint64_t total(const uint64_t (&counts)[ACCESS_KIND_COUNT]) {
+    return counts[ACCESS_READ] + counts[ACCESS_WRITE] + counts[ACCESS_FETCH];
+}
+}
+
+void AccessProfiler::AccessCounts::clear() {
+    memset(this, 0, sizeof(*this));
+}
+
+void AccessProfiler::AccessCounts::add(const AccessCounts& other) {
+    for (int page = 0; page < WATCH_PAGE_COUNT; ++page) {
+        for (int kind = 0; kind < ACCESS_KIND_COUNT; ++kind) {
+            pages[page][kind] += other.pages[page][kind];
+        }
+    }
+    for (int region = 0; region < MEMORY_REGION_COUNT; ++region) {
+        for (int kind = 0; kind < ACCESS_KIND_COUNT; ++kind) {
+            regions[region][kind] += other.regions[region][kind];
+        }
+    }
+    for (int i = 0; i < BANK_WRITE_KINDS; ++i) {
+        bankWrites[i] += other.bankWrites[i];
+    }
+}
+
+AccessProfiler::AccessProfiler(const std::string& csvPath, bool perFrame)
+    : m_PerFrame(perFrame)
+    , m_Finished(false)
+    , m_FrameNumber(0)
+{
+    m_Frame.clear();
+    m_Session.clear();
+    m_Csv.open(csvPath, std::ios::out | std::ios::trunc);
+    if (!m_Csv.is_open()) {
+        LOG_ERROR("Failed to open access profile CSV: " + csvPath);
+        return;
+    }
+    m_Csv << "frame,scope,name,reads,writes,fetches\n";
+    LOG_INFO("Access profiler writing " + std::string(perFrame ? "per-frame" : "per-session") + " CSV to " + csvPath);
+}
+
+void AccessProfiler::writeRows(const std::string& frame, const AccessCounts& counts) {
+    if (!m_Csv.is_open()) {
+        return;
+    }
+    for (int region = 0; region < MEMORY_REGION_COUNT; ++region) {
+        const uint64_t (&c)[ACCESS_KIND_COUNT] = counts.regions[region];
+        if (total(c) == 0) continue;
+        m_Csv << frame << ",region," << getMemoryRegionName(static_cast<MemoryRegion>(region)) << ","
+              << c[ACCESS_READ] << "," << c[ACCESS_WRITE] << "," << c[ACCESS_FETCH] << "\n";
+    }
+    for (int page = 0; page < WATCH_PAGE_COUNT; ++page) {
+        const uint64_t (&c)[ACCESS_KIND_COUNT] = counts.pages[page];
+        if (total(c) == 0) continue;
+        m_Csv << frame << ",page,0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << page
+              << std::dec << "," << c[ACCESS_READ] << "," << c[ACCESS_WRITE] << "," << c[ACCESS_FETCH] << "\n";
+    }
+    for (int i = 0; i < BANK_WRITE_KINDS; ++i) {
+        if (counts.bankWrites[i] == 0) continue;
+        m_Csv << frame << ",mbc," << BANK_WRITE_NAMES[i] << ",0," << counts.bankWrites[i] << ",0\n";
+    }
+}
+
+void AccessProfiler::endFrame() {
+    if (m_PerFrame) {
+        writeRows(std::to_string(m_FrameNumber), m_Frame);
+    }
+    m_Session.add(m_Frame);
+    m_Frame.clear();
+    m_FrameNumber++;
+}
+
+void AccessProfiler::finish() {
+    if (m_Finished) {
+        return;
+    }
+    m_Session.add(m_Frame);  // Partial last frame
+    m_Frame.clear();
+    if (!m_PerFrame) {
+        writeRows("session", m_Session);
+    }
+    m_Csv.flush();
+    m_Finished = true;
+}
+
+std::string AccessProfiler::summary() const {
+    std::stringstream ss;
+    uint64_t frames = std::max<uint64_t>(m_FrameNumber, 1);
+
+    ss << "=== Memory access profile (" << m_FrameNumber << " frames) ===\n";
+    ss << std::left << std::setw(18) << "region" << std::right
+       << std::setw(14) << "reads" << std::setw(14) << "writes" << std::setw(14) << "fetches"
+       << std::setw(14) << "per frame" << "\n";
+    for (int region = 0; region < MEMORY_REGION_COUNT; ++region) {
+        const uint64_t (&c)[ACCESS_KIND_COUNT] = m_Session.regions[region];
+        if (total(c) == 0) continue;
+        ss << std::left << std::setw(18) << getMemoryRegionName(static_cast<MemoryRegion>(region)) << std::right
+           << std::setw(14) << c[ACCESS_READ] << std::setw(14) << c[ACCESS_WRITE]
+           << std::setw(14) << c[ACCESS_FETCH] << std::setw(14) << total(c) / frames << "\n";
+    }
+
+    // Hottest pages
+    std::vector<int> pages;
+    for (int page = 0; page < WATCH_PAGE_COUNT; ++page) {
+        if (total(m_Session.pages[page]) > 0) pages.push_back(page);
+    }
+    std::sort(pages.begin(), pages.end(), [this](int a, int b) {
+        return total(m_Session.pages[a]) > total(m_Session.pages[b]);
+    });
+    if (pages.size() > 10) pages.resize(10);
+    ss << "Hottest pages:\n";
+    for (int page : pages) {
+        const uint64_t (&c)[ACCESS_KIND_COUNT] = m_Session.pages[page];
+        ss << "  0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << page
+           << "00" << std::dec << std::setfill(' ')
+           << "  r=" << c[ACCESS_READ] << " w=" << c[ACCESS_WRITE] << " x=" << c[ACCESS_FETCH] << "\n";
+    }
+
+    ss << "MBC register writes:";
+    for (int i = 0; i < BANK_WRITE_KINDS; ++i) {
+        ss << " " << BANK_WRITE_NAMES[i] << "=" << m_Session.bankWrites[i];
+    }
+    ss << "\n";
+    return ss.str();
+}
@@ -0,0 +1,43 @@
+#include <accuracy_policy.h>
+#include <config_file.h>
+#include <logger.h>
+
+namespace GB {
+
+namespace {
+std::string fileName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+}
+
+std::string romConfigValue(const std::string& configPath, const std::string& romPath, const std::string& romTitle) {
+    const std::string romFile = fileName(romPath);
+    std::string match;
+    std::string fallback;
+    readConfigFile(configPath, [&](const std::string& key, const std::string& value, const std::string&) {
+        if (key == romFile || (!romTitle.empty() && key == romTitle)) {
+            match = value;
+            return false;
+        }
+        if (key == "default") {
+            fallback = value;
+        }
+        return true;
+    });
+    return match.empty() ? fallback : match;
+}
+
+AccuracyMode accuracyModeForRom(const std::string& configPath, const std::string& romPath, const std::string& romTitle) {
+    std::string value = romConfigValue(configPath, romPath, romTitle);
+    if (value.empty() || value == InstructionStepped::NAME) {
+        return AccuracyMode::FAST;
+    }
+    if (value == MCycleAccurate::NAME) {
+        return AccuracyMode::ACCURATE;
+    }
+    LOG_WARNING(configPath + ": unknown accuracy '" + value + "', using " + InstructionStepped::NAME);
+    return AccuracyMode::FAST;
+}
+
+} // namespace GB
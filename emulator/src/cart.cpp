@@ -168,52 +168,46 @@ bool cart_load(char *cart) {
 */
 
 Cart::Cart()
+    : currentROMBank(1)
+    , currentRAMBank(0)
+    , ramEnabled(false)
+    , romBankingMode(true)
+    , m_CartridgeRAM(nullptr)
+    , m_CartridgeRAMSize(0)
+    , m_HeaderRAMSize(0)
+    , loaded(false)
+    , cartridgeType(0)
+    , hasRAM(false)
+    , hasBattery(false)
 {
-    this->loaded=false;
 }
 
 Cart::~Cart()
 {
-    this->unload();
-    this->m_CartridgeMemory.clear();
+    if (loaded) {
+        this->unload();
+    }
 }
 
 bool Cart::load(const std::string &filename)
 {
     LOG_INFO("Attempting to load ROM: " + filename);
 
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        LOG_ERROR("Failed to open ROM file: " + filename);
-        return false;
-    }
-
-    file.seekg(0, std::ios::end);
-    std::streampos fileSize = file.tellg();
-    if (fileSize <= 0) {
-        LOG_ERROR("Invalid ROM file size: " + std::to_string(fileSize));
+    m_Rom = RomImageRegistry::getInstance().acquire(filename);
+    if (!m_Rom) {
+        LOG_ERROR("Failed to load ROM file: " + filename);
         loaded = false;
         return false;
     }
-    LOG_INFO("Expected ROM file size: " + std::to_string(fileSize) + " bytes"); // Log expected size
-    // Check if ROM size is valid
-    m_CartridgeMemory.resize(fileSize);
-    file.seekg(0, std::ios::beg);
-    file.read(reinterpret_cast<char*>(m_CartridgeMemory.data()), fileSize);
-
-    std::streamsize bytesRead = file.gcount(); // Get actual bytes read
-    LOG_INFO("Bytes actually read from ROM: " + std::to_string(bytesRead)); // Log actual bytes read
-
-    if (!file || bytesRead != fileSize) { // Check if read was successful and complete
-        LOG_ERROR("Failed to read ROM file completely: " + filename + " (Read " + std::to_string(bytesRead) + " bytes)");
-        // Optionally clear memory or handle error more robustly
-        m_CartridgeMemory.assign(m_CartridgeMemory.size(), 0xFF); // Fill with a known value on error?
+    if (m_Rom->size() < 0x150) {
+        LOG_ERROR("ROM file too small to hold a header: " + std::to_string(m_Rom->size()) + " bytes");
+        m_Rom.reset();
         loaded = false;
         return false;
     }
-     LOG_INFO("ROM file read successfully.");
+    LOG_INFO("ROM file read successfully (" + std::to_string(m_Rom->size()) + " bytes).");
     // Get ROM header information (starting at 0x100)
-    const rom_header* header = reinterpret_cast<const rom_header*>(m_CartridgeMemory.data() + 0x100);
+    const rom_header* header = reinterpret_cast<const rom_header*>(m_Rom->data() + 0x100);
     
     // Log cartridge info
     std::string title(header->title, 16);
@@ -223,7 +217,7 @@ bool Cart::load(const std::string &filename)
     LOG_INFO("ROM Version: " + std::to_string(header->version));
 
     // Check for checksum
-    BYTE checksum = calculate_gameboy_header_checksum(m_CartridgeMemory);
+    BYTE checksum = calculate_gameboy_header_checksum(*m_Rom);
     if (checksum != header->checksum) {
         LOG_WARNING("Checksum mismatch: expected " + std::to_string(header->checksum) + ", calculated " + std::to_string(checksum));
     } else {
@@ -231,21 +225,28 @@ bool Cart::load(const std::string &filename)
     }
 
     loaded = true;
+    initBanking();
     LOG_INFO("Cartridge loaded successfully");
-    LOG_DEBUG("Writing rom data to file for debugging");
-    std::ofstream debugFile("rom_dump.txt", std::ios::binary);
-    //translate to hex
-    for (size_t i = 0; i < m_CartridgeMemory.size(); ++i) {
-        debugFile << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(m_CartridgeMemory[i]) << " ";
-        if ((i + 1) % 16 == 0) {
-            debugFile << "\n";
+    LOG_INFO("ROM image shared by " + std::to_string(m_Rom.use_count()) + " instance(s), " +
+             std::to_string(m_Rom->size()) + " bytes resident once");
+
+    // Only the first instance of a ROM writes the debug dump
+    if (m_Rom.use_count() == 1) {
+        LOG_DEBUG("Writing rom data to file for debugging");
+        std::ofstream debugFile("rom_dump.txt", std::ios::binary);
+        //translate to hex
+        for (size_t i = 0; i < m_Rom->size(); ++i) {
+            debugFile << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>((*m_Rom)[i]) << " ";
+            if ((i + 1) % 16 == 0) {
+                debugFile << "\n";
+            }
         }
+        debugFile.close();
+        LOG_INFO("ROM data written to rom_dump.txt for debugging purposes.");
     }
-    debugFile.close();
-    LOG_INFO("ROM data written to rom_dump.txt for debugging purposes.");
     return true;
 }
-BYTE Cart::calculate_gameboy_header_checksum(const std::vector<unsigned char>& cartridge_memory)const {
+BYTE Cart::calculate_gameboy_header_checksum(const RomImage& cartridge_memory)const {
     BYTE checksum = 0; // BYTE is unsigned char, 8-bit unsigned arithmetic
     for (size_t address = 0x0134; address <= 0x014C; ++address) {
         checksum = checksum - cartridge_memory[address] - 1;
@@ -259,8 +260,10 @@ bool Cart::unload() {
         return true;
     }
 
-    // Clear cartridge memory
-    m_CartridgeMemory.clear();
+    // Release our reference to the shared ROM image and the RAM binding
+    m_Rom.reset();
+    m_CartridgeRAM = nullptr;
+    m_CartridgeRAMSize = 0;
     loaded = false;
     
     LOG_INFO("Cartridge unloaded successfully");
@@ -273,8 +276,7 @@ void Cart::initBanking() {
         return;
     }
     // Initialize banking registers
-    BYTE* cartridgeMemory = m_CartridgeMemory.data();
-    rom_header* header = reinterpret_cast<rom_header*>(cartridgeMemory + 0x100);
+    const rom_header* header = reinterpret_cast<const rom_header*>(m_Rom->data() + 0x100);
     cartridgeType = header->type;
     
     // Initialize banking registers
@@ -299,11 +301,50 @@ void Cart::initBanking() {
             hasBattery = (cartridgeType == 0x03);
             break;
         // ... add more types as needed
+        default:
+            hasRAM = false;
+            hasBattery = false;
+            break;
+    }
+
+    // External RAM is provided by the machine state block via attachRAM()
+    size_t ramSize = 0;
+    if (hasRAM) {
+        switch (header->ram_size) {
+            case 0x01: ramSize = 0x800;   break; // 2KB
+            case 0x02: ramSize = 0x2000;  break; // 8KB
+            case 0x03: ramSize = 0x8000;  break; // 32KB (4 banks)
+            case 0x04: ramSize = 0x20000; break; // 128KB (16 banks)
+            case 0x05: ramSize = 0x10000; break; // 64KB (8 banks)
+            default:   ramSize = 0;       break;
+        }
+    }
+    m_HeaderRAMSize = ramSize;
+}
+
+void Cart::attachRAM(BYTE* ram, size_t size) {
+    m_CartridgeRAM = ram;
+    m_CartridgeRAMSize = (size < m_HeaderRAMSize) ? size : m_HeaderRAMSize;
+    if (m_CartridgeRAMSize < m_HeaderRAMSize) {
+        LOG_WARNING("Cartridge declares " + std::to_string(m_HeaderRAMSize) + " bytes of RAM, only " +
+                    std::to_string(m_CartridgeRAMSize) + " are backed");
+    }
+}
+
+std::string Cart::getTitle() const {
+    if (!loaded) {
+        return "";
+    }
+    const rom_header* header = reinterpret_cast<const rom_header*>(m_Rom->data() + 0x100);
+    size_t length = 0;
+    while (length < sizeof(header->title) && header->title[length] != 0) {
+        length++;
     }
+    return std::string(header->title, length);
 }
 
 BYTE Cart::read(WORD address) {
-    if (!loaded || address >= m_CartridgeMemory.size()) {
+    if (!loaded || address >= m_Rom->size()) {
         LOG_ERROR("Cartridge read error: Address 0x" + std::to_string(address) + " out of bounds or ROM not loaded.");
         return 0xFF; // Return a default value on error
     }
@@ -345,7 +386,7 @@ void Cart::write(WORD address, BYTE data) {
 
 BYTE Cart::readROMOnly(WORD address) {
     if (address < 0x8000) {
-        return m_CartridgeMemory[address];
+        return (*m_Rom)[address];
     }
     return 0xFF;
 }
@@ -358,17 +399,19 @@ void Cart::writeROMOnly(WORD address, BYTE data) {
 BYTE Cart::readMBC1(WORD address) {
     if (address < 0x4000) {
         // ROM Bank 0
-        return m_CartridgeMemory[address];
+        return (*m_Rom)[address];
     }
     else if (address < 0x8000) {
         // ROM Bank 1-127
-        WORD bankAddress = (address - 0x4000) + (currentROMBank * 0x4000);
-        return m_CartridgeMemory[bankAddress];
+        size_t bankAddress = (address - 0x4000) + (currentROMBank * 0x4000);
+        if (bankAddress >= m_Rom->size()) return 0xFF; // Never read past the mapping
+        return (*m_Rom)[bankAddress];
     }
     else if (address >= 0xA000 && address < 0xC000) {
         // RAM Banks
         if (ramEnabled && hasRAM) {
-            WORD ramAddress = (address - 0xA000) + (currentRAMBank * 0x2000);
+            size_t ramAddress = (address - 0xA000) + (currentRAMBank * 0x2000);
+            if (ramAddress >= m_CartridgeRAMSize) return 0xFF;
             return m_CartridgeRAM[ramAddress];
         }
     }
@@ -401,7 +444,8 @@ void Cart::writeMBC1(WORD address, BYTE data) {
     else if (address >= 0xA000 && address < 0xC000) {
         // RAM Banks
         if (ramEnabled && hasRAM) {
-            WORD ramAddress = (address - 0xA000) + (currentRAMBank * 0x2000);
+            size_t ramAddress = (address - 0xA000) + (currentRAMBank * 0x2000);
+            if (ramAddress >= m_CartridgeRAMSize) return;
             m_CartridgeRAM[ramAddress] = data;
         }
     }
@@ -411,16 +455,17 @@ void Cart::writeMBC1(WORD address, BYTE data) {
 BYTE Cart::readMBC2(WORD address) {
     if (address < 0x4000) {
         // ROM Bank 0
-        return m_CartridgeMemory[address];
+        return (*m_Rom)[address];
     }
     else if (address < 0x8000) {
         // ROM Bank 1-15
-        WORD bankAddress = (address - 0x4000) + (currentROMBank * 0x4000);
-        return m_CartridgeMemory[bankAddress];
+        size_t bankAddress = (address - 0x4000) + (currentROMBank * 0x4000);
+        if (bankAddress >= m_Rom->size()) return 0xFF; // Never read past the mapping
+        return (*m_Rom)[bankAddress];
     }
     else if (address >= 0xA000 && address < 0xA200) {
         // MBC2 has built-in RAM of 512 x 4 bits
-        if (ramEnabled) {
+        if (ramEnabled && static_cast<size_t>(address - 0xA000) < m_CartridgeRAMSize) {
             return m_CartridgeRAM[address - 0xA000] & 0x0F;
         }
     }
@@ -443,27 +488,25 @@ void Cart::writeMBC2(WORD address, BYTE data) {
     }
     else if (address >= 0xA000 && address < 0xA200) {
         // RAM Banks
-        if (ramEnabled) {
+        if (ramEnabled && static_cast<size_t>(address - 0xA000) < m_CartridgeRAMSize) {
             m_CartridgeRAM[address - 0xA000] = data & 0x0F;
         }
     }
 }
 
 bool Cart::verifyChecksum() const {
-    // Use const_cast to maintain const correctness
-    BYTE *romData = const_cast<BYTE*>(m_CartridgeMemory.data());
-    const rom_header* header = reinterpret_cast<const rom_header*>( romData+ 0x100);
+    const rom_header* header = reinterpret_cast<const rom_header*>(m_Rom->data() + 0x100);
     WORD checksum = 0;
     
     for (WORD addr = HEADER_START; addr <= HEADER_END; addr++) {
-        checksum = checksum - m_CartridgeMemory[addr] - 1;
+        checksum = checksum - (*m_Rom)[addr] - 1;
     }
 
     return (checksum & CHECKSUM_MASK) == header->checksum;
 }
 
 void Cart::saveRAM() const {
-    if (!hasBattery || !hasRAM || !loaded) {
+    if (!hasBattery || !hasRAM || !loaded || !m_CartridgeRAM) {
         return;
     }
 
@@ -477,7 +520,7 @@ void Cart::saveRAM() const {
     }
     // Save RAM data
     
-    file.write(reinterpret_cast<const char*>(m_CartridgeRAM.data()), m_CartridgeRAM.size());
+    file.write(reinterpret_cast<const char*>(m_CartridgeRAM), m_CartridgeRAMSize);
     if (file.fail()) {
         LOG_ERROR("Failed writing save data");
     } else {
@@ -486,7 +529,7 @@ void Cart::saveRAM() const {
 }
 
 void Cart::loadRAM() {
-    if (!hasBattery || !hasRAM || !loaded) {
+    if (!hasBattery || !hasRAM || !loaded || !m_CartridgeRAM) {
         return;
     }
 
@@ -499,7 +542,7 @@ void Cart::loadRAM() {
         return;
     }
 
-    file.read(reinterpret_cast<char*>(m_CartridgeRAM.data()), m_CartridgeRAM.size());
+    file.read(reinterpret_cast<char*>(m_CartridgeRAM), m_CartridgeRAMSize);
     if (file.fail()) {
         LOG_ERROR("Failed reading save data");
     } else {
@@ -0,0 +1,39 @@
+#include <config_file.h>
+#include <logger.h>
+#include <fstream>
+
+std::string trimConfigText(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+bool readConfigFile(const std::string& path, const ConfigEntry& entry) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = trimConfigText(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            LOG_WARNING(where + "expected '<key> = <value>'");
+            continue;
+        }
+        if (!entry(trimConfigText(line.substr(0, equals)), trimConfigText(line.substr(equals + 1)), where)) {
+            break;
+        }
+    }
+    return true;
+}
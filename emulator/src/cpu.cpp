@@ -16,115 +16,139 @@ namespace GB {
 // --- Constructor ---
 CPU::CPU(std::shared_ptr<MemoryController> memory)
     : memoryController(memory),
-      halted(false),
-      stopped(false),
-      interruptEnabled(false),
-      pendingInterruptEnable(false),
+      m_Regs(memory->state().cpu),
       opcodeTables(OpcodeTables::getInstance()) // Initialize reference to singleton
 {
     Reset();
     LOG_INFO("CPU initialized and reset.");
 }
 
+template <typename Policy>
+CPUCore<Policy>::CPUCore(std::shared_ptr<MemoryController> memory)
+    : CPU(std::move(memory)),
+      m_TickedCycles(0)
+{
+    LOG_INFO(std::string("CPU core: ") + Policy::NAME);
+}
+
 // --- CPU Reset ---
 void CPU::Reset() {
     // Initial register values for DMG
-    m_RegisterAF.reg = 0x01B0;
-    m_RegisterBC.reg = 0x0013;
-    m_RegisterDE.reg = 0x00D8;
-    m_RegisterHL.reg = 0x014D;
-    m_ProgramCounter = 0x0100;
-    m_StackPointer.reg = 0xFFFE;
-
-    halted = false;
-    stopped = false;
-    interruptEnabled = false;
-    pendingInterruptEnable = false;
+    m_Regs.af.reg = 0x01B0;
+    m_Regs.bc.reg = 0x0013;
+    m_Regs.de.reg = 0x00D8;
+    m_Regs.hl.reg = 0x014D;
+    m_Regs.pc = 0x0100;
+    m_Regs.sp.reg = 0xFFFE;
+
+    m_Regs.halted = false;
+    m_Regs.stopped = false;
+    m_Regs.ime = false;
+    m_Regs.pendingIme = false;
 
     LOG_INFO("CPU reset to initial state. PC=0x0100, SP=0xFFFE");
 }
 
-// --- Memory Access ---
-BYTE CPU::readMemory(WORD address) const {
-    return memoryController->read(address);
-}
-
-void CPU::writeMemory(WORD address, BYTE data) {
-    memoryController->write(address, data);
-}
-
-BYTE CPU::readBytePC() {
-    BYTE value = readMemory(m_ProgramCounter);
-    m_ProgramCounter++; // This increments the PC
-    return value;
-}
-
-WORD CPU::readWordPC() {
-    BYTE lo = readBytePC(); // Reads at PC, increments PC
-    BYTE hi = readBytePC(); // Reads at new PC, increments PC
-    return (static_cast<WORD>(hi) << 8) | lo;
-}
-
 // --- Flag Management ---
 // ... (Flag setters/getters remain the same) ...
 void CPU::setFlagZ(bool value) {
-    if (value) m_RegisterAF.lo |= FLAG_Z_MASK;
-    else m_RegisterAF.lo &= ~FLAG_Z_MASK;
+    if (value) m_Regs.af.lo |= FLAG_Z_MASK;
+    else m_Regs.af.lo &= ~FLAG_Z_MASK;
 }
 void CPU::setFlagN(bool value) {
-    if (value) m_RegisterAF.lo |= FLAG_N_MASK;
-    else m_RegisterAF.lo &= ~FLAG_N_MASK;
+    if (value) m_Regs.af.lo |= FLAG_N_MASK;
+    else m_Regs.af.lo &= ~FLAG_N_MASK;
 }
 void CPU::setFlagH(bool value) {
-    if (value) m_RegisterAF.lo |= FLAG_H_MASK;
-    else m_RegisterAF.lo &= ~FLAG_H_MASK;
+    if (value) m_Regs.af.lo |= FLAG_H_MASK;
+    else m_Regs.af.lo &= ~FLAG_H_MASK;
 }
 void CPU::setFlagC(bool value) {
-    if (value) m_RegisterAF.lo |= FLAG_C_MASK;
-    else m_RegisterAF.lo &= ~FLAG_C_MASK;
+    if (value) m_Regs.af.lo |= FLAG_C_MASK;
+    else m_Regs.af.lo &= ~FLAG_C_MASK;
+}
+
+bool CPU::getFlagZ() const { return (m_Regs.af.lo & FLAG_Z_MASK) != 0; }
+bool CPU::getFlagN() const { return (m_Regs.af.lo & FLAG_N_MASK) != 0; }
+bool CPU::getFlagH() const { return (m_Regs.af.lo & FLAG_H_MASK) != 0; }
+bool CPU::getFlagC() const { return (m_Regs.af.lo & FLAG_C_MASK) != 0; }
+
+
+// --- Memory Access ---
+// One bus M-cycle: the clock moves before the access, so the access sees
+// timer, PPU and DMA state at its own cycle
+template <typename Policy>
+void CPUCore<Policy>::tick() {
+    memoryController->tickMCycle();
+    m_TickedCycles += 4;
 }
 
-bool CPU::getFlagZ() const { return (m_RegisterAF.lo & FLAG_Z_MASK) != 0; }
-bool CPU::getFlagN() const { return (m_RegisterAF.lo & FLAG_N_MASK) != 0; }
-bool CPU::getFlagH() const { return (m_RegisterAF.lo & FLAG_H_MASK) != 0; }
-bool CPU::getFlagC() const { return (m_RegisterAF.lo & FLAG_C_MASK) != 0; }
+template <typename Policy>
+BYTE CPUCore<Policy>::readMemory(WORD address) {
+    if constexpr (Policy::TICK_PER_ACCESS) tick();
+    return memoryController->cpuRead(address);
+}
+
+template <typename Policy>
+void CPUCore<Policy>::writeMemory(WORD address, BYTE data) {
+    if constexpr (Policy::TICK_PER_ACCESS) tick();
+    memoryController->cpuWrite(address, data);
+}
 
+template <typename Policy>
+BYTE CPUCore<Policy>::readBytePC() {
+    if constexpr (Policy::TICK_PER_ACCESS) tick();
+    BYTE value = memoryController->cpuFetch(m_Regs.pc);
+    m_Regs.pc++; // This increments the PC
+    return value;
+}
+
+template <typename Policy>
+WORD CPUCore<Policy>::readWordPC() {
+    BYTE lo = readBytePC(); // Reads at PC, increments PC
+    BYTE hi = readBytePC(); // Reads at new PC, increments PC
+    return (static_cast<WORD>(hi) << 8) | lo;
+}
 
 // --- Stack Operations ---
-void CPU::pushStackWord(WORD value) {
-    m_StackPointer.reg--;
-    writeMemory(m_StackPointer.reg, (value >> 8) & 0xFF); // Push MSB
-    m_StackPointer.reg--;
-    writeMemory(m_StackPointer.reg, value & 0xFF);        // Push LSB
+template <typename Policy>
+void CPUCore<Policy>::pushStackWord(WORD value) {
+    m_Regs.sp.reg--;
+    writeMemory(m_Regs.sp.reg, (value >> 8) & 0xFF); // Push MSB
+    m_Regs.sp.reg--;
+    writeMemory(m_Regs.sp.reg, value & 0xFF);        // Push LSB
 }
 
-WORD CPU::popStackWord() {
-    BYTE lo = readMemory(m_StackPointer.reg);        // Pop LSB
-    m_StackPointer.reg++;
-    BYTE hi = readMemory(m_StackPointer.reg);        // Pop MSB
-    m_StackPointer.reg++;
+template <typename Policy>
+WORD CPUCore<Policy>::popStackWord() {
+    BYTE lo = readMemory(m_Regs.sp.reg);        // Pop LSB
+    m_Regs.sp.reg++;
+    BYTE hi = readMemory(m_Regs.sp.reg);        // Pop MSB
+    m_Regs.sp.reg++;
     return (static_cast<WORD>(hi) << 8) | lo;
 }
 
 // --- Interrupt Handling ---
 // ... (Interrupt handling code remains the same) ...
 void CPU::RequestInterrupt(BYTE interruptBit) {
-    BYTE currentIF = readMemory(IF_REGISTER);
-    writeMemory(IF_REGISTER, currentIF | interruptBit);
+    BYTE currentIF = memoryController->read(IF_REGISTER);
+    memoryController->write(IF_REGISTER, currentIF | interruptBit);
 }
 
-int CPU::handleInterrupts() {
-    if (!interruptEnabled && !halted) {
-        return 0; // No interrupts to handle if interrupts are disabled and not halted
+template <typename Policy>
+int CPUCore<Policy>::handleInterrupts() {
+    if (!m_Regs.ime && !m_Regs.halted) {
+        return 0; // No interrupts to handle if interrupts are disabled and not m_Regs.halted
     }
 
-    BYTE IE = readMemory(IE_REGISTER);
-    BYTE IF = readMemory(IF_REGISTER);
-    BYTE requestedAndEnabled = IE & IF;
+    // Polling IE/IF is internal to the CPU, not a bus access
+    BYTE IE = memoryController->read(IE_REGISTER);
+    BYTE IF = memoryController->read(IF_REGISTER);
+    BYTE requestedAndEnabled = IE & IF & 0x1F;
     // *** ADD THIS LOG ***
     if ((IE & IF) != 0) { // Log only if there's potential for an interrupt
         std::stringstream ss;
-        ss << "HandleInterrupts Check: IME=" << interruptEnabled
+        ss << "HandleInterrupts Check: IME=" << m_Regs.ime
         << " IE=0x" << std::hex << static_cast<int>(IE)
         << " IF=0x" << static_cast<int>(IF)
         << " ReqEn=0x" << static_cast<int>(requestedAndEnabled);
@@ -134,11 +158,11 @@ int CPU::handleInterrupts() {
         return 0; // No interrupts to handle
     }
 
-    if (halted) {
-        halted = false;
+    if (m_Regs.halted) {
+        m_Regs.halted = false;
     }
 
-    if (!interruptEnabled) {
+    if (!m_Regs.ime) {
         return 0; // Interrupts are disabled, do not handle them
     }
 
@@ -163,10 +187,10 @@ int CPU::handleInterrupts() {
     }
 
     if (interruptToService != 0) {
-        interruptEnabled = false;
-        writeMemory(IF_REGISTER, IF & ~interruptToService);
-        pushStackWord(m_ProgramCounter);
-        m_ProgramCounter = interruptAddress;
+        m_Regs.ime = false;
+        memoryController->write(IF_REGISTER, IF & ~interruptToService);
+        pushStackWord(m_Regs.pc);
+        m_Regs.pc = interruptAddress;
         LOG_DEBUG("Servicing Interrupt - Type: 0x" + std::to_string(interruptToService) + " Addr: 0x" + std::to_string(interruptAddress));
         LOG_DEBUG("Interrupt serviced successfully.");
     }
@@ -193,19 +217,24 @@ void CPU::logOpcodeExecution(BYTE opcode_val, bool is_prefixed, const OpcodeInfo
 
 
 // --- Core Execution Logic ---
-int CPU::ExecuteNextOpcode() {
-    handleInterrupts(); // Check for and handle interrupts first
-
-    if (pendingInterruptEnable) {
-        interruptEnabled = true;
-        pendingInterruptEnable = false;
+template <typename Policy>
+int CPUCore<Policy>::ExecuteNextOpcode() {
+    m_TickedCycles = 0;
+    int interruptCycles = handleInterrupts(); // Check for and handle interrupts first
+
+    if (m_Regs.pendingIme) {
+        m_Regs.ime = true;
+        m_Regs.pendingIme = false;
     }
 
-    if (halted) {
-        return 4; // 1 M-cycle (4 T-cycles)
+    if (m_Regs.halted) {
+        return finishInstruction(4); // 1 M-cycle (4 T-cycles)
     }
 
-    WORD pc_before_fetch = m_ProgramCounter;
+    WORD pc_before_fetch = m_Regs.pc;
+    if (memoryController->beginInstruction(pc_before_fetch)) {
+        return finishInstruction(interruptCycles); // Execute watchpoint: stop before the fetch
+    }
     BYTE opcode = readBytePC(); // Fetch opcode, PC is now advanced
 
     // *** ADDED LOG 1: Log the fetched byte immediately ***
@@ -229,31 +258,42 @@ int CPU::ExecuteNextOpcode() {
 
     // *** Log PC before processInstruction ***
     std::stringstream ssbefore;
-    ssbefore << "PC before processInstruction: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_ProgramCounter;
+    ssbefore << "PC before processInstruction: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_Regs.pc;
     LOG_DEBUG(ssbefore.str());
 
     int cycles = processInstruction(info);
 
     // *** Log PC after processInstruction ***
     std::stringstream ssafter;
-    ssafter << "PC after processInstruction: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_ProgramCounter;
+    ssafter << "PC after processInstruction: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_Regs.pc;
     LOG_DEBUG(ssafter.str());
 
     if (cycles < 0) {
         LOG_ERROR("Error processing opcode: 0x" + std::to_string(opcode) + " at PC: 0x" + std::to_string(pc_before_fetch));
         return cycles;
     }
+    cycles += interruptCycles;
 
     // *** ADDED LOG 3: Log PC right before returning cycles ***
     std::stringstream ssreturn;
-    ssreturn << "PC before returning cycles: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_ProgramCounter;
+    ssreturn << "PC before returning cycles: 0x" << std::hex << std::setw(4) << std::setfill('0') << m_Regs.pc;
     LOG_DEBUG(ssreturn.str());
 
 
-    // The total cycles for the instruction is the sum of CPU cycles and hardware cycles
-    // However, ExecuteNextOpcode is expected to return the CPU cycles for the instruction itself
-    // The timer/ppu updates consume cycles based on the CPU cycles.
-    // The return value should be the CPU cycles returned by processInstruction
+    // The total includes the interrupt dispatch (if any) that preceded the instruction
+    return finishInstruction(cycles);
+}
+
+// The accurate core has already put the bus cycles on the clock; what is left
+// are internal cycles (ALU, branch, dispatch wait states)
+template <typename Policy>
+int CPUCore<Policy>::finishInstruction(int cycles) {
+    if constexpr (Policy::TICK_PER_ACCESS) {
+        if (cycles < m_TickedCycles) {
+            cycles = m_TickedCycles;
+        }
+        memoryController->scheduler().advance(cycles - m_TickedCycles);
+    }
     return cycles;
 }
 
@@ -261,10 +301,11 @@ int CPU::ExecuteNextOpcode() {
 
 
 // ... (processInstruction and handleUnknownOpcode remain the same) ...
-int CPU::processInstruction(const OpcodeInfo& info) {
+template <typename Policy>
+int CPUCore<Policy>::processInstruction(const OpcodeInfo& info) {
     //log state before executing the instruction
-    //LOG_DEBUG("Processing instruction: " + info.mnemonic + " at PC: 0x" + std::to_string(m_ProgramCounter - info.length));
-    LOG_INFO("Processing instruction: " + info.mnemonic + " at PC: 0x" + std::to_string(m_ProgramCounter - info.length) +
+    //LOG_DEBUG("Processing instruction: " + info.mnemonic + " at PC: 0x" + std::to_string(m_Regs.pc - info.length));
+    LOG_INFO("Processing instruction: " + info.mnemonic + " at PC: 0x" + std::to_string(m_Regs.pc - info.length) +
              " | AF:0x" + std::to_string(getAF()) +
              " BC:0x" + std::to_string(getBC()) +
              " DE:0x" + std::to_string(getDE()) +
@@ -485,15 +526,19 @@ int CPU::processInstruction(const OpcodeInfo& info) {
 }
 
 
-int CPU::handleUnknownOpcode(BYTE opcode, bool prefixed) {
+template <typename Policy>
+int CPUCore<Policy>::handleUnknownOpcode(BYTE opcode, bool prefixed) {
     std::stringstream ss;
     ss << "Unknown or unimplemented opcode: " << (prefixed ? "CB " : "")
        << "0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(opcode)
-       << " at PC=0x" << std::hex << std::setw(4) << std::setfill('0') << (m_ProgramCounter - (prefixed ? 2 : 1)); // PC is already advanced
+       << " at PC=0x" << std::hex << std::setw(4) << std::setfill('0') << (m_Regs.pc - (prefixed ? 2 : 1)); // PC is already advanced
     LOG_ERROR(ss.str());
     // You might want to throw an exception or stop emulation here
     // For now, return a default cycle count to avoid infinite loops if possible
     return 4;
 }
 
+template class CPUCore<InstructionStepped>;
+template class CPUCore<MCycleAccurate>;
+
 } // namespace GB
@@ -3,6 +3,7 @@
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <functional>
+#include <algorithm>
 #include <iostream>
 #include <cpu.h>  // Full include here, not in header
 
@@ -31,17 +32,36 @@
 #endif
 
 
+// Speed ratios selectable with +/- ({0, 1} = uncapped)
+namespace {
+constexpr uint32_t SPEED_STEPS[][2] = { {1, 4}, {1, 2}, {1, 1}, {2, 1}, {4, 1}, {0, 1} };
+constexpr int SPEED_STEP_COUNT = sizeof(SPEED_STEPS) / sizeof(SPEED_STEPS[0]);
+constexpr int SPEED_STEP_NORMAL = 2;
+
+constexpr ColorScheme COLOR_SCHEMES[] = { COLOR_SCHEME_GREYSCALE, COLOR_SCHEME_DMG_GREEN };
+constexpr int COLOR_SCHEME_COUNT = sizeof(COLOR_SCHEMES) / sizeof(COLOR_SCHEMES[0]);
+}
+
 Emulator::Emulator()
     : window(nullptr)
     , renderer(nullptr)
     , texture(nullptr)
+    , headless(false)
     , loaded(false)
     , emulationActive(false)
     , running(false)
-    , emulationSpeed(1.0f)  // Initialize first (matches declaration order)
     , debugMode(false)      // Initialize second
     , paused(false)         // Initialize third
     // Continue with other members in declaration order
+    , fastCore(nullptr)
+    , accurateCore(nullptr)
+    , accuracyMode(GB::AccuracyMode::FAST)
+    , speedStep(SPEED_STEP_NORMAL)
+    , colorSchemeStep(0)
+    , uploadedFrame(UINT32_MAX)
+    , presentNeeded(true)
+    , screenshotCount(0)
+    , memoryLocked(false)
     , keyFunction_array()
     , joypad()
 {
@@ -56,16 +76,65 @@ Emulator::Emulator()
     keyMap[SDLK_UP] = JOYPAD_UP;
     keyMap[SDLK_DOWN] = JOYPAD_DOWN;
     keyMap[SDLK_LSHIFT] = -2; // Special key handling
-    keyFunction_array[0] = [this](int key) { this->KeyReleased(key); }; // Released (0)
-    keyFunction_array[1] = [this](int key) { this->KeyPressed(key); }; // Pressed (1)
+    // Live keys go straight to the joypad; deterministic runs queue them so
+    // they are pinned to a guest cycle and recorded
+    keyFunction_array[0] = [this](int key) { // Released (0)
+        if (deterministic.load()) postCommand({CommandType::KEY, static_cast<BYTE>(key), false, 0, 0});
+        else joypad.publish(key, false);
+    };
+    keyFunction_array[1] = [this](int key) { // Pressed (1)
+        if (deterministic.load()) postCommand({CommandType::KEY, static_cast<BYTE>(key), true, 0, 0});
+        else joypad.publish(key, true);
+    };
 }
 
 Emulator::~Emulator() {
     cleanup();
 }
-bool Emulator::init() {
+
+bool Emulator::init(bool headlessMode) {
     LOG_INFO("Initializing emulator...");
+    headless = headlessMode;
+
+    if (!headless && !initVideo()) {
+        return false;
+    }
+
+    // Initialize core components
+    memoryController = std::make_shared<MemoryController>();
+    if (!memoryController) {
+         LOG_ERROR("Failed to initialize Memory Controller");
+         cleanupVideo();
+         return false;
+    }
+    // Pass 'this' emulator instance to MemoryController AFTER it's constructed
+    memoryController->attachEmulator(this);
+    threadPlacement = loadThreadPlacementConfig(THREAD_CONFIG_FILE);
+
+    createCPU(GB::AccuracyMode::FAST);
+    ppu = std::make_unique<PPU>(memoryController);
+    timer = std::make_unique<GB::Timer>(memoryController); // Pass MemoryController to Timer
+    // Register writes (TAC, DIV, LCDC, ...) reschedule these components' events
+    memoryController->attachTimer(timer.get());
+    memoryController->attachPPU(ppu.get());
 
+    if (!cpu || !ppu || !timer) {
+        LOG_ERROR("Failed to initialize core components (CPU, PPU, or Timer)");
+        memoryController.reset(); // Release MemoryController
+        cleanupVideo();
+        return false;
+    }
+
+    // Set initial state
+    running = false; // Should be set true by run()
+    loaded = false;
+
+    LOG_INFO(headless ? "Emulator initialized (headless)" : "Emulator initialized successfully");
+    return true;
+}
+
+// SDL, SDL_ttf, the window and the streaming texture frames are uploaded to
+bool Emulator::initVideo() {
     if (!SDL_Init(SDL_INIT_VIDEO)){ // Check return value of SDL_Init
         LOG_ERROR("SDL could not initialize! SDL_Error: " + std::string(SDL_GetError()));
         return false;
@@ -104,59 +173,30 @@ bool Emulator::init() {
         return false;
     }
 
-
-    // Initialize core components
-    memoryController = std::make_shared<MemoryController>();
-    if (!memoryController) {
-         LOG_ERROR("Failed to initialize Memory Controller");
-         // Cleanup SDL resources before returning
-         SDL_DestroyTexture(texture);
-         SDL_DestroyRenderer(renderer);
-         SDL_DestroyWindow(window);
-         TTF_Quit();
-         SDL_Quit();
-         return false;
-    }
-    // Pass 'this' emulator instance to MemoryController AFTER it's constructed
-    memoryController->attachEmulator(this);
-
-    cpu = std::make_unique<GB::CPU>(memoryController);
-    ppu = std::make_unique<PPU>(memoryController);
-    timer = std::make_unique<GB::Timer>(memoryController); // Pass MemoryController to Timer
-
-    if (!cpu || !ppu || !timer) {
-        LOG_ERROR("Failed to initialize core components (CPU, PPU, or Timer)");
-        // Cleanup SDL and MemoryController
-        memoryController.reset(); // Release MemoryController
-        SDL_DestroyTexture(texture);
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        TTF_Quit();
-        SDL_Quit();
-        return false;
-    }
-
-    // Set initial state
-    running = false; // Should be set true by run()
-    loaded = false;
-
-    LOG_INFO("Emulator initialized successfully");
     return true;
 }
-void Emulator::pauseEmulation(bool pause) {
-    if (pause) {
-        std::unique_lock<std::mutex> lock(pauseMutex); // Lock the mutex for pausing
-        paused = true; // Set the paused state
-        LOG_INFO("Emulator paused.");
+
+// Replaces the CPU core; the register state lives in the machine state
+// block, so the new core carries on from it
+void Emulator::createCPU(GB::AccuracyMode mode) {
+    fastCore = nullptr;
+    accurateCore = nullptr;
+    if (mode == GB::AccuracyMode::ACCURATE) {
+        auto core = std::make_unique<GB::AccurateCPU>(memoryController);
+        accurateCore = core.get();
+        cpu = std::move(core);
     } else {
-        // Implementation for resuming the emulation (if needed)
-        // This could involve resetting a flag in the CPU or Emulator class
-        // to indicate that the emulation should resume.
-        LOG_INFO("Emulator resumed.");
-        std::unique_lock<std::mutex> lock(pauseMutex);
-        paused = false; // Reset the paused state
-        pauseCondition.notify_all(); // Notify any waiting threads
+        auto core = std::make_unique<GB::FastCPU>(memoryController);
+        fastCore = core.get();
+        cpu = std::move(core);
     }
+    accuracyMode = mode;
+}
+
+// Emulation thread (or with the thread stopped); the UI posts PAUSE commands
+void Emulator::pauseEmulation(bool pause) {
+    paused = pause;
+    LOG_INFO(pause ? "Emulator paused." : "Emulator resumed.");
 }
 bool Emulator::loadGame(const std::string& gamePath) {
     LOG_INFO("Loading game: " + gamePath);
@@ -185,6 +225,13 @@ bool Emulator::loadGame(const std::string& gamePath) {
          return false;
     }
 
+    GB::AccuracyMode mode = GB::accuracyModeForRom(GB::ACCURACY_CONFIG_FILE, gamePath, cart->getTitle());
+    if (mode != accuracyMode) {
+        createCPU(mode);
+    }
+    ppu->setEngine(ppuEngineForRom(PPU_CONFIG_FILE, gamePath, cart->getTitle()));
+    ppu->setRenderThread(usePPUThread(threadPlacement), threadPlacement);
+
     if (!memoryController->attachCart(std::move(cart))) {
         LOG_ERROR("Failed to attach cart to memory controller");
         return false;
@@ -254,6 +301,10 @@ void Emulator::run() {
         LOG_ERROR("No game loaded. Cannot run emulation.");
         return;
     }
+    if (headless) {
+        LOG_ERROR("run() needs a window; a headless emulator is driven by stepFrame/stepCycles");
+        return;
+    }
     if (emulationActive.load()) {
         LOG_WARNING("Emulation is already running.");
         return;
@@ -262,26 +313,40 @@ void Emulator::run() {
     // Start emulation in separate thread
     startEmulation();
 
-    // Main thread handles SDL events and rendering
+    // Main thread handles SDL events and rendering. It blocks on the event
+    // queue rather than sleeping, so a key is published as soon as SDL
+    // delivers it; rendering runs on its own ~60 Hz deadline.
+    placeCurrentThread(threadPlacement, ThreadRole::RENDER);
     running = true; // Keep the main loop running
+    uint64_t nextRenderNs = SDL_GetTicksNS();
     while (running) {
-        // Process SDL events
+        uint64_t nowNs = SDL_GetTicksNS();
+        if (nowNs >= nextRenderNs) {
+            render();
+            nextRenderNs += RENDER_INTERVAL_NS;
+            if (nextRenderNs <= nowNs) {
+                nextRenderNs = nowNs + RENDER_INTERVAL_NS; // Don't replay missed renders
+            }
+            continue;
+        }
+
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        int timeoutMs = static_cast<int>((nextRenderNs - nowNs + 999999) / 1000000);
+        if (!SDL_WaitEventTimeout(&event, timeoutMs)) {
+            continue; // Render deadline reached
+        }
+        do {
             if (event.type == SDL_EVENT_QUIT) {
                 running = false; // Signal main loop and emulation thread to stop
                 emulationActive.store(false); // Ensure emulation thread knows to exit
-                pauseCondition.notify_all(); // Wake up thread if paused
+                wakeEmulationThread(); // Wake up thread if paused
+            }
+            if (event.type == SDL_EVENT_WINDOW_EXPOSED || event.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+                presentNeeded = true; // The window lost its contents
             }
             // Handle input
             handleInput(event);
-        }
-
-        // Render the current frame
-        render();
-
-        // Control rendering frame rate (smoother than the emulation thread)
-        SDL_Delay(16); // ~60fps
+        } while (SDL_PollEvent(&event));
     }
 
     // Clean up the emulation thread AFTER the main loop exits
@@ -293,16 +358,27 @@ void Emulator::cleanup() {
 
     // Ensure emulation is stopped first
     stopEmulation();
+    stopAccessProfiler();
 
     if (loaded) {
         unloadGame();
     }
 
+    if (memoryController) {
+        memoryController->attachTimer(nullptr);
+        memoryController->attachPPU(nullptr);
+    }
     cpu.reset();
     ppu.reset();
     timer.reset(); // Reset timer pointer
     memoryController.reset(); // Reset memory controller pointer
 
+    cleanupVideo();
+
+    LOG_INFO("Cleanup complete");
+}
+
+void Emulator::cleanupVideo() {
     if (texture) {
         SDL_DestroyTexture(texture);
         texture = nullptr;
@@ -315,67 +391,166 @@ void Emulator::cleanup() {
         SDL_DestroyWindow(window);
         window = nullptr;
     }
-
-    TTF_Quit();
-    SDL_Quit();
-
-    LOG_INFO("Cleanup complete");
+    if (!headless) {
+        TTF_Quit();
+        SDL_Quit();
+    }
 }
 
-// This function seems like a duplicate or debug version of emulationLoop.
-// Keeping it for now, but likely should be removed or merged with emulationLoop.
+// Runs one 1/120 s slice (CYCLES_PER_FRAME) from wherever the clock is (debug/test driver)
 void Emulator::update()
 {
-    int cyclesThisUpdate = 0;
-    const int CYCLES_PER_UPDATE = CYCLES_PER_FRAME; // Or some other value if this is for debugging
+    if (!cpu) {
+        LOG_ERROR("CPU not initialized in update()");
+        return;
+    }
+    stepCycles(CYCLES_PER_FRAME);
+}
 
-    while (cyclesThisUpdate < CYCLES_PER_UPDATE) {
-        if (!cpu) {
-            LOG_ERROR("CPU not initialized in update()");
-            return;
+// Runs until the clock reaches `target`, applying scheduled inputs at their
+// cycles on the way. Returns false on a CPU error or a watchpoint hit (which
+// has already been reported).
+bool Emulator::runUntil(uint64_t target) {
+    Scheduler& scheduler = memoryController->scheduler();
+    while (scheduler.now() < target) {
+        applyDueInputs();
+        uint64_t limit = target;
+        if (!scheduledInputs.empty() && scheduledInputs.front().cycle < limit) {
+            limit = scheduledInputs.front().cycle;
         }
-        // LOG_DEBUG("Debug mode value: " + std::to_string(debugMode.load())); // Can be noisy
-        static int totalCycles = 0; // Static variable here might be problematic if update() is called repeatedly
 
-        int cycles = cpu->ExecuteNextOpcode();
+        // Runs the CPU up to the next peripheral event, then that event's handler
+        if (runToNextEvent(limit) < 0) {
+            LOG_ERROR("CPU execution error at cycle " + std::to_string(scheduler.now()));
+            emulationActive.store(false); // Stop emulation on error
+            return false;
+        }
+        if (memoryController->hasWatchHit()) {
+            reportWatchpointHit(); // Pauses; the emulation loop waits on pauseCondition
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the CPU until the next scheduler deadline (or `limit`, if sooner), then
+// dispatches the events that came due. Timer, PPU, DMA and serial only do work
+// here instead of being polled after every instruction.
+// Returns the T-cycles that elapsed, or -1 on a CPU error.
+int Emulator::runToNextEvent(uint64_t limit) {
+    Scheduler& scheduler = memoryController->scheduler();
+    const uint64_t start = scheduler.now();
+
+    int result = accurateCore ? runCore(*accurateCore, limit) : runCore(*fastCore, limit);
+    if (result < 0) {
+        return -1;
+    }
+
+    scheduler.runDueEvents();
+    checkJoypadInterrupt();
+    return static_cast<int>(scheduler.now() - start);
+}
+
+// The fast core leaves the clock alone and is advanced here after each
+// instruction; the accurate core has already ticked it access by access.
+template <typename Core>
+int Emulator::runCore(Core& core, uint64_t limit) {
+    Scheduler& scheduler = memoryController->scheduler();
+
+    // The deadline is re-read every instruction: a register write (DMA, TAC,
+    // LCDC, ...) may just have scheduled an earlier event
+    while (scheduler.now() < limit && !scheduler.hasDueEvents()) {
+        int cycles = core.ExecuteNextOpcode();
         if (cycles < 0) {
-             LOG_ERROR("CPU execution error in update()");
-             running = false; // Stop emulation on error
-             emulationActive.store(false);
-             return;
+            return -1;
+        }
+        if constexpr (Core::Timing::TICK_PER_ACCESS) {
+            cycles = 0;
+        }
+        const uint64_t until = std::min(scheduler.nextDeadline(), limit);
+        if (core.isHalted() && scheduler.now() < until) {
+            // Only an event can wake the CPU now - skip straight to it, and
+            // never past it, so where a run is split does not change timing
+            cycles = static_cast<int>(until - scheduler.now());
         }
-        cyclesThisUpdate += cycles;
-        totalCycles += cycles;
-
-        // *** Update Timer and PPU here as well if this function is used ***
-        if (timer) timer->update(cycles);
-        if (ppu) ppu->update(cycles);
-        // cyclesThisUpdate += handleInterrupts(); // handleInterrupts doesn't return cycles
-
-        // Log less frequently
-        // if (totalCycles % 10000 < cycles) {
-        //     LOG_DEBUG("Update() CPU cycles: " + std::to_string(totalCycles) +
-        //              ", PPU enabled: " + (ppu ? std::to_string(ppu->isLCDEnabled()) : "N/A"));
-        // }
-        if (cyclesThisUpdate >= CYCLES_PER_UPDATE) {
+        scheduler.advance(cycles);
+        if (memoryController->hasWatchHit()) {
             break;
         }
     }
-    // LOG_INFO("Update() completed with cycles: " + std::to_string(cyclesThisUpdate)); // Can be noisy
+    return 0;
 }
 
 int Emulator::handleInterrupts() { // Should probably return void now
     if (!cpu) {
         return 0; // Return 0 cycles if no CPU
     }
-    cpu->handleInterrupts(); // Call the CPU's handler
-    // Interrupt handling cycles (20 T-cycles) are implicitly handled
-    // by the fact that the CPU doesn't execute another instruction
-    // during the interrupt service routine fetch/setup.
-    // If precise cycle accounting is needed *outside* the CPU,
-    // cpu->handleInterrupts could return the cycle cost.
-    return 0; // Currently returns void, so return 0 cycles.
+    // Call the CPU's handler. ExecuteNextOpcode already counts the dispatch
+    // cycles, so nothing is returned here.
+    if (accurateCore) {
+        accurateCore->handleInterrupts();
+    } else {
+        fastCore->handleInterrupts();
+    }
+    return 0;
+}
+int Emulator::addWatchpoint(WORD start, WORD end, BYTE types) {
+    if (!memoryController) {
+        LOG_ERROR("Memory Controller not initialized, cannot set watchpoint");
+        return -1;
+    }
+    return memoryController->watchpoints().add(start, end, types);
+}
+
+bool Emulator::removeWatchpoint(int id) {
+    if (!memoryController) {
+        return false;
+    }
+    return memoryController->watchpoints().remove(id);
+}
+
+void Emulator::clearWatchpoints() {
+    if (memoryController) {
+        memoryController->watchpoints().clear();
+    }
+}
+
+bool Emulator::startAccessProfiler(const std::string& csvPath, bool perFrame) {
+    if (emulationActive.load()) {
+        LOG_ERROR("Cannot start the access profiler while emulation is active");
+        return false;
+    }
+    if (!memoryController) {
+        LOG_ERROR("Memory Controller not initialized, cannot start the access profiler");
+        return false;
+    }
+    auto profiler = std::make_unique<AccessProfiler>(csvPath, perFrame);
+    if (!profiler->isOpen()) {
+        return false;
+    }
+    memoryController->startProfiler(std::move(profiler));
+    return true;
 }
+
+void Emulator::stopAccessProfiler() {
+    if (emulationActive.load()) {
+        LOG_ERROR("Cannot stop the access profiler while emulation is active");
+        return;
+    }
+    if (!memoryController || !memoryController->isProfiling()) {
+        return;
+    }
+    std::unique_ptr<AccessProfiler> profiler = memoryController->stopProfiler();
+    profiler->finish();
+    std::cout << profiler->summary();
+}
+
+void Emulator::reportWatchpointHit() {
+    WatchHit hit = memoryController->takeWatchHit();
+    LOG_WARNING(Watchpoints::describe(hit));
+    pauseEmulation(true);
+}
+
 void Emulator::RequestInterrupt(BYTE interruptBit) {
     if (!cpu) {
         LOG_ERROR("CPU not initialized, cannot request interrupt");
@@ -396,6 +571,9 @@ void Emulator::startEmulation() {
     // running = true; // Set by run()
     paused = false;
     emulationActive.store(true); // Use store for atomic bool
+    if (threadPlacement.lockMemory && !memoryLocked) {
+        memoryLocked = lockProcessMemory(); // Before the thread starts, so its stack is locked too
+    }
 
     // Start emulation in a separate thread
     emulatorThread = std::thread(&Emulator::emulationLoop, this);
@@ -410,32 +588,171 @@ void Emulator::stopEmulation() {
     emulationActive.store(false); // Signal thread to stop
 
     // Wake up the thread if it's paused
-    {
-        // std::lock_guard<std::mutex> lock(screenBufferMutex); // No need to lock screen buffer mutex here
-        pauseCondition.notify_all();
-    }
+    wakeEmulationThread();
 
     // Wait for thread to finish
     if (emulatorThread.joinable()) {
         emulatorThread.join();
     }
+    if (memoryLocked) {
+        unlockProcessMemory();
+        memoryLocked = false;
+    }
 
     // running should be controlled by the main loop (SDL events)
     // running = false;
 
+    InputLatencyStats latency = joypad.latencyStats();
+    if (latency.samples > 0) {
+        LOG_INFO("Input latency: " + std::to_string(latency.samples) + " key changes, mean " +
+                 std::to_string(latency.meanUs) + " us, max " + std::to_string(latency.maxUs) + " us");
+    }
     LOG_INFO("Emulation thread stopped");
 }
 
-void Emulator::setEmulationSpeed(float speed) {
-    if (speed <= 0.0f) {
-        LOG_WARNING("Attempted to set invalid emulation speed: " + std::to_string(speed));
-        return;
+void Emulator::setEmulationSpeed(uint32_t numerator, uint32_t denominator) {
+    postCommand({CommandType::SPEED, 0, false, numerator, denominator});
+}
+
+void Emulator::setColorScheme(const ColorScheme& scheme) {
+    EmulatorCommand command = {CommandType::COLOR_SCHEME, 0, false, 0, 0};
+    memcpy(command.shades, scheme.shades, sizeof(command.shades));
+    postCommand(command);
+}
+
+bool Emulator::postCommand(const EmulatorCommand& command) {
+    if (!commands.push(command)) {
+        LOG_WARNING("Command queue full, dropping command " + std::to_string(static_cast<int>(command.type)));
+        return false;
     }
-    emulationSpeed.store(speed);
-    LOG_INFO("Emulation speed set to " + std::to_string(speed) + "x");
+    wakeEmulationThread();
+    return true;
 }
+
+// The empty critical section orders the wake-up after the waiter's predicate
+// check, so a notification cannot slip in between it and the wait
+void Emulator::wakeEmulationThread() {
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+    }
+    pauseCondition.notify_all();
+}
+
+void Emulator::drainCommands() {
+    EmulatorCommand command;
+    while (commands.pop(command)) {
+        applyCommand(command);
+    }
+}
+
+// Emulation thread, between frames
+void Emulator::applyCommand(const EmulatorCommand& command) {
+    Scheduler& scheduler = memoryController->scheduler();
+    switch (command.type) {
+        case CommandType::KEY:
+            if (deterministic.load()) {
+                scheduleInput(scheduler.now(), command.key, command.pressed);  // Recorded for replay
+            } else {
+                applyInput(command.key, command.pressed);
+            }
+            break;
+        case CommandType::PAUSE:
+            pauseEmulation(command.pressed);
+            break;
+        case CommandType::TOGGLE_PAUSE:
+            pauseEmulation(!paused);
+            break;
+        case CommandType::TOGGLE_DEBUG:
+            toggleDebugMode();
+            break;
+        case CommandType::SPEED:
+            pacer.setSpeed(command.numerator, command.denominator);
+            if (command.numerator == 0) {
+                LOG_INFO("Emulation speed set to uncapped");
+            } else {
+                LOG_INFO("Emulation speed set to " + std::to_string(command.numerator) + "/" +
+                         std::to_string(command.denominator) + "x");
+            }
+            break;
+        case CommandType::RESET:
+            // The input log only holds keys: a replay could not repeat a
+            // reset or a state load, so they are refused while recording
+            if (deterministic.load()) {
+                LOG_WARNING("Reset ignored in deterministic mode");
+                break;
+            }
+            resetMachine();
+            pacer.restart(scheduler.now());
+            break;
+        case CommandType::SAVE_STATE:
+            if (!quickSave) {
+                quickSave = std::make_unique<MachineState>();
+            }
+            memoryController->saveState(*quickSave);
+            LOG_INFO("State saved at cycle " + std::to_string(scheduler.now()));
+            break;
+        case CommandType::LOAD_STATE:
+            if (deterministic.load()) {
+                LOG_WARNING("State load ignored in deterministic mode");
+                break;
+            }
+            if (!quickSave) {
+                LOG_WARNING("No saved state to load");
+                break;
+            }
+            memoryController->loadState(*quickSave);
+            pacer.restart(scheduler.now());  // The clock jumped
+            LOG_INFO("State loaded, cycle " + std::to_string(scheduler.now()));
+            break;
+        case CommandType::SCREENSHOT:
+            saveScreenshot();
+            break;
+        case CommandType::COLOR_SCHEME: {
+            ColorScheme scheme;
+            memcpy(scheme.shades, command.shades, sizeof(scheme.shades));
+            ppu->setColorScheme(scheme);  // From the next completed frame
+            break;
+        }
+    }
+}
+
+// Soft reset: CPU, PPU and timer back to power-on, memory and cart kept
+void Emulator::resetMachine() {
+    cpu->Reset();
+    ppu->reset();
+    timer->reset();
+    LOG_INFO("Machine reset");
+}
+
+bool Emulator::saveScreenshot() {
+    ppu->catchUp();
+    std::vector<Uint32> frame = ppu->getScreenBuffer();  // RGBA copy; SDL wants mutable pixels
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(SCREEN_PIXELS_WIDTH, SCREEN_PIXELS_HEIGHT, SDL_PIXELFORMAT_RGBA8888,
+                                                 frame.data(), SCREEN_PIXELS_WIDTH * sizeof(Uint32));
+    if (!surface) {
+        LOG_ERROR("Failed to create screenshot surface: " + std::string(SDL_GetError()));
+        return false;
+    }
+    std::string path = "screenshot_" + std::to_string(screenshotCount++) + ".bmp";
+    bool saved = SDL_SaveBMP(surface, path.c_str());
+    SDL_DestroySurface(surface);
+    if (!saved) {
+        LOG_ERROR("Failed to save " + path + ": " + std::string(SDL_GetError()));
+        return false;
+    }
+    LOG_INFO("Screenshot saved to " + path);
+    return true;
+}
+void Emulator::setFrameskip(FrameskipMode mode, int fixedSkip) {
+    pacer.setFrameskip(mode, fixedSkip);
+    switch (mode) {
+        case FrameskipMode::OFF:   LOG_INFO("Frameskip off"); break;
+        case FrameskipMode::FIXED: LOG_INFO("Frameskip fixed: " + std::to_string(fixedSkip)); break;
+        case FrameskipMode::AUTO:  LOG_INFO("Frameskip auto"); break;
+    }
+}
+// UI thread: everything that affects the machine is posted as a command
 void Emulator::handleInput(const SDL_Event& event) {
-    std::lock_guard<std::mutex> lock(inputMutex); // Lock the joypad state
     // LOG_INFO("Event received: " + std::to_string(event.type)); // Can be very noisy
 
     if (event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) {
@@ -445,20 +762,40 @@ void Emulator::handleInput(const SDL_Event& event) {
 
         // Handle Emulator controls first
         if (keyCode == SDLK_P) {
-            if (pressed) pauseEmulation(!paused); // Toggle pause on press
+            if (pressed) postCommand({CommandType::TOGGLE_PAUSE, 0, false, 0, 0}); // Toggle pause on press
             return;
         }
         if (keyCode == SDLK_O) {
-            if (pressed) toggleDebugMode(); // Toggle debug on press
+            if (pressed) postCommand({CommandType::TOGGLE_DEBUG, 0, false, 0, 0}); // Toggle debug on press
+            return;
+        }
+        if (keyCode == SDLK_F1 || keyCode == SDLK_F5 || keyCode == SDLK_F7 || keyCode == SDLK_F12) {
+            static const std::unordered_map<SDL_Keycode, CommandType> functionKeys = {
+                {SDLK_F1, CommandType::RESET}, {SDLK_F5, CommandType::SAVE_STATE},
+                {SDLK_F7, CommandType::LOAD_STATE}, {SDLK_F12, CommandType::SCREENSHOT}};
+            if (pressed && !event.key.repeat) postCommand({functionKeys.at(keyCode), 0, false, 0, 0});
+            return;
+        }
+        if (keyCode == SDLK_F2) {
+            if (pressed && !event.key.repeat) {
+                colorSchemeStep = (colorSchemeStep + 1) % COLOR_SCHEME_COUNT;
+                setColorScheme(COLOR_SCHEMES[colorSchemeStep]);
+            }
             return;
         }
         // Speed controls (example)
         if (keyCode == SDLK_EQUALS || keyCode == SDLK_PLUS) { // Increase speed
-             if (pressed) setEmulationSpeed(emulationSpeed.load() * 1.1f);
+             if (pressed && speedStep + 1 < SPEED_STEP_COUNT) {
+                 speedStep++;
+                 setEmulationSpeed(SPEED_STEPS[speedStep][0], SPEED_STEPS[speedStep][1]);
+             }
              return;
         }
         if (keyCode == SDLK_MINUS) { // Decrease speed
-             if (pressed) setEmulationSpeed(emulationSpeed.load() / 1.1f);
+             if (pressed && speedStep > 0) {
+                 speedStep--;
+                 setEmulationSpeed(SPEED_STEPS[speedStep][0], SPEED_STEPS[speedStep][1]);
+             }
              return;
         }
 
@@ -470,8 +807,8 @@ void Emulator::handleInput(const SDL_Event& event) {
         }
 
         int key = keyMap[keyCode];
-        if (key >= 0) { // Ensure it's a valid Game Boy key index
-            keyFunction_array[pressed ? 1 : 0](key); // Call KeyPressed or KeyReleased
+        if (key >= 0 && !event.key.repeat) { // Ensure it's a valid Game Boy key index
+            keyFunction_array[pressed ? 1 : 0](key); // Post a key press or release
         }
     }
 }
@@ -488,70 +825,62 @@ void Emulator::toggleDebugMode()
 
 void Emulator::emulationLoop()
 {
-    // Timing variables
-    auto lastTime = std::chrono::high_resolution_clock::now();
-    double accumulatedCycles = 0.0; // Use double for better precision
+    Scheduler& scheduler = memoryController->scheduler();
+    placeCurrentThread(threadPlacement, ThreadRole::EMULATION);
+    schedMonitor.restart();
+    pacer.restart(scheduler.now());
 
+    bool wasPaused = false;
     while (emulationActive.load()) { // Use atomic bool for loop condition
-        // Handle paused state
-        { // Scope for unique_lock
-            std::unique_lock<std::mutex> lock(pauseMutex);  // Use the pause mutex here
-            pauseCondition.wait(lock, [this]() { return !paused || !emulationActive; });
-        } // Lock released here
-
-        if (!emulationActive.load()) break; // Exit if stopped while paused
-
-        // Calculate target cycles for this frame based on speed
-        double targetCycles = static_cast<double>(CYCLES_PER_FRAME) * emulationSpeed.load();
-        accumulatedCycles = 0.0; // Reset accumulated cycles for the frame
-
-        // Run CPU cycles for one frame's worth of time
-        while (accumulatedCycles < targetCycles && emulationActive.load()) {
-            if (!cpu) {
-                LOG_ERROR("CPU is null in emulation loop!");
-                emulationActive.store(false); // Stop emulation
-                break;
-            }
-             if (!timer) {
-                LOG_ERROR("Timer is null in emulation loop!");
-                emulationActive.store(false); // Stop emulation
-                break;
-            }
-             if (!ppu) {
-                LOG_ERROR("PPU is null in emulation loop!");
-                emulationActive.store(false); // Stop emulation
-                break;
-            }
+        // UI commands take effect here, between frames
+        drainCommands();
+        if (paused) {
+            // Sleep until the UI posts something (a resume) or stops the thread
+            std::unique_lock<std::mutex> lock(pauseMutex);
+            pauseCondition.wait(lock, [this]() { return !commands.empty() || !emulationActive.load(); });
+            wasPaused = true;
+            continue;
+        }
+        if (wasPaused) {
+            pacer.restart(scheduler.now()); // Wall time spent paused is not owed to the guest
+            wasPaused = false;
+        }
 
-            int cycles = cpu->ExecuteNextOpcode();
-            if (cycles < 0) {
-                LOG_ERROR("CPU execution error in emulation loop");
-                emulationActive.store(false); // Stop emulation on error
-                break;
-            }
+        if (!cpu || !ppu || !timer) {
+            LOG_ERROR("Core component missing in emulation loop!");
+            emulationActive.store(false); // Stop emulation
+            break;
+        }
 
-            accumulatedCycles += cycles;
+        // Run one LCD frame; frame ends are on an absolute cycle grid, so an
+        // instruction overshooting the boundary is carried into the next frame
+        const uint64_t frameEnd = pacer.frameEnd();
+        ppu->setSkipRendering(!deterministic.load() && !pacer.shouldRenderFrame());
+        runUntil(frameEnd);
 
-            // *** Update Timer and PPU with the cycles executed ***
-            timer->update(cycles);
-            ppu->update(cycles);
+        ppu->catchUp();  // Present every line of the frame, observed or not
+        memoryController->endProfilerFrame();
 
-            // Interrupt handling cycles are implicitly handled by CPU execution flow
-            // No need to add extra cycles here unless handleInterrupts returns a cost
-            // handleInterrupts(); // Called at the start of ExecuteNextOpcode now
+        if (scheduler.now() < frameEnd) {
+            continue; // Interrupted by a watchpoint or a stop - not a finished frame
         }
-
-        // Frame timing (optional, can rely on VSync in render or SDL_Delay)
-        // This simple sleep might not be the most accurate timing method.
-        // Consider more advanced timing techniques if needed.
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto frameDuration = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - lastTime);
-        int64_t targetFrameDuration = static_cast<int64_t>(1000000.0 / TARGET_FPS); // Target based on 60fps
-
-        if (frameDuration.count() < targetFrameDuration) {
-            std::this_thread::sleep_for(std::chrono::microseconds(targetFrameDuration - frameDuration.count()));
+        // Sleep until the frame's wall-clock deadline
+        if (pacer.endFrame(scheduler.now())) {
+            PacingStats stats = pacer.stats();
+            LOG_DEBUG("Pacing: " + std::to_string(stats.fps) + " fps, " + std::to_string(stats.speed) +
+                      "x, " + std::to_string(stats.lateFrames) + " late, " + std::to_string(stats.skippedFrames) +
+                      " skipped (" + std::to_string(stats.totalLateFrames) + " late, " +
+                      std::to_string(stats.totalSkippedFrames) + " skipped of " + std::to_string(stats.totalFrames) + ")" +
+                      ", input latency " + std::to_string(joypad.latencyStats().lastUs) + " us");
+            if (schedMonitor.sample()) {
+                ThreadSchedReport sched = schedMonitor.report();
+                if (sched.available) {
+                    LOG_INFO("Emulation thread: " + std::to_string(sched.contextSwitchesPerMin) + " context switches/min (" +
+                             std::to_string(sched.involuntarySwitchesPerMin) + " involuntary), " +
+                             std::to_string(sched.migrationsPerMin) + " migrations/min");
+                }
+            }
         }
-        lastTime = std::chrono::high_resolution_clock::now(); // Update time for next frame calculation
     }
      LOG_INFO("Exiting emulation loop.");
 }
@@ -564,9 +893,6 @@ void Emulator::render() {
         return;
     }
 
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Black background
-    SDL_RenderClear(renderer);
-
     // Use atomic load for debugMode check
     if (debugMode.load()) {
         // Optionally render debug info or a specific pattern
@@ -575,112 +901,181 @@ void Emulator::render() {
         // LOG_DEBUG("Rendering in debug mode");
     }
 
-    // Lock before accessing the screen buffer from PPU
-    {
-        std::lock_guard<std::mutex> lock(screenBufferMutex); // Use the screen buffer mutex
-        void* texturePixels = nullptr;
-        int pitch = 0;
-
-        // *** Add check before locking ***
-        if (!texture) {
-             LOG_ERROR("Texture pointer is null before SDL_LockTexture!");
-             return;
-        }
+    // Only rows that changed since the last upload are copied. Skipped frames
+    // and frames identical to the last one change nothing, and then the
+    // window is not redrawn either unless SDL asked for it. The frame comes
+    // from the PPU's triple buffer, so it is complete and nothing writes it.
+    bool fresh = false;
+    const PPUFrame& frame = ppu->acquireFrame(fresh);
+    if (fresh || uploadedFrame == UINT32_MAX) {
+        int firstRow = 0;
+        int lastRow = 0;
+        bool dirty = ppu->getDirtyRows(uploadedFrame, firstRow, lastRow);
+        uploadedFrame = frame.sequence;
+        if (dirty) {
+            SDL_Rect rows = { 0, firstRow, SCREEN_PIXELS_WIDTH, lastRow - firstRow + 1 };
+            void* texturePixels = nullptr;
+            int pitch = 0;
+
+            // Lock the dirty rows of the texture for writing
+            if (!SDL_LockTexture(texture, &rows, &texturePixels, &pitch)) {
+                // *** Improved Error Logging ***
+                const char* sdlError = SDL_GetError(); // Get error *immediately*
+                LOG_ERROR("Failed to lock texture: " + (sdlError ? std::string(sdlError) : "Unknown SDL Error"));
+                uploadedFrame = UINT32_MAX; // Upload everything next time
+                return; // Skip rendering if lock fails
+            }
 
-        // Lock the texture for writing
-        if (SDL_LockTexture(texture, nullptr, &texturePixels, &pitch) != 0) {
-            // *** Improved Error Logging ***
-            const char* sdlError = SDL_GetError(); // Get error *immediately*
-            LOG_ERROR("Failed to lock texture: " + (sdlError ? std::string(sdlError) : "Unknown SDL Error"));
-            return; // Skip rendering if lock fails
-        }
+            // Shade indices through the frame's colour scheme into the texture
+            // Check if texturePixels is valid before converting
+            if (texturePixels) {
+                 // Ensure the PPU buffer size matches the expected texture size
+                 size_t expectedSize = static_cast<size_t>(SCREEN_PIXELS_WIDTH) * SCREEN_PIXELS_HEIGHT;
+                 if (frame.shades.size() == expectedSize) {
+                     convertShades(frame.shades.data() + static_cast<size_t>(firstRow) * SCREEN_PIXELS_WIDTH,
+                                   SCREEN_PIXELS_WIDTH, rows.h, frame.palette, FramePixelFormat::RGBA8888,
+                                   texturePixels, pitch);
+                 } else {
+                      LOG_ERROR("PPU buffer size mismatch! Expected: " + std::to_string(expectedSize) + ", Got: " + std::to_string(frame.shades.size()));
+                      // Optionally fill texture with a solid color to indicate error
+                      memset(texturePixels, 0xFF, static_cast<size_t>(pitch) * rows.h); // Fill with white on error
+                 }
+            } else {
+                 LOG_ERROR("SDL_LockTexture succeeded but returned null pixels pointer!");
+            }
 
-        // Copy the PPU buffer to the texture
-        // Check if texturePixels is valid before memcpy
-        if (texturePixels) {
-             // Ensure the PPU buffer size matches the expected texture size
-             const auto& ppuBuffer = ppu->getScreenBuffer();
-             size_t expectedSize = static_cast<size_t>(SCREEN_PIXELS_WIDTH) * SCREEN_PIXELS_HEIGHT * sizeof(Uint32);
-             if (ppuBuffer.size() * sizeof(Uint32) == expectedSize) {
-                 memcpy(texturePixels, ppuBuffer.data(), expectedSize);
-             } else {
-                  LOG_ERROR("PPU buffer size mismatch! Expected: " + std::to_string(expectedSize) + ", Got: " + std::to_string(ppuBuffer.size() * sizeof(Uint32)));
-                  // Optionally fill texture with a solid color to indicate error
-                  memset(texturePixels, 0xFF, pitch * SCREEN_PIXELS_HEIGHT); // Fill with white on error
-             }
-        } else {
-             LOG_ERROR("SDL_LockTexture succeeded but returned null pixels pointer!");
+            // Unlock the texture
+            SDL_UnlockTexture(texture);
+            presentNeeded = true;
         }
-
-
-        // Unlock the texture
-        SDL_UnlockTexture(texture);
-    } // Mutex lock released here
-
-    // Render the texture to the screen
-    // *** Add check before rendering ***
-    if (!renderer || !texture) {
-         LOG_ERROR("Renderer or Texture became null before SDL_RenderTexture!");
-         return;
     }
+    if (!presentNeeded) {
+        return;
+    }
+    presentNeeded = false;
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Black background
+    SDL_RenderClear(renderer);
     SDL_RenderTexture(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
 }
 
 BYTE Emulator::GetJoypadState() {
-    // This logic seems okay, but ensure memoryController->read/write are thread-safe
-    // if accessed from multiple threads (input thread vs emulation thread).
-    // Using a mutex for joypad state itself is good.
-    std::lock_guard<std::mutex> lock(inputMutex); // Lock joypad state access
-    BYTE joypadRequest = memoryController->read(JOYPAD_REGISTER);
-    // Start with lower nibble high (unpressed), upper nibble from register write
-    BYTE joypadOutput = (joypadRequest & 0xF0) | 0x0F;
-
-    if (!(joypadRequest & JOYPAD_SELECT_DIRECTIONS)) { // Bit 4 low: Directions selected
-        joypadOutput &= (joypad.GetJoypadState() & 0x0F); // AND with lower nibble state
-    } else if (!(joypadRequest & JOYPAD_SELECT_BUTTONS)) { // Bit 5 low: Buttons selected
-        joypadOutput &= (joypad.GetJoypadState() >> 4);   // AND with upper nibble state (shifted down)
+    return memoryController->read(JOYPAD_REGISTER);
+}
+
+void Emulator::applyInput(int key, bool pressed) {
+    if (pressed) {
+        joypad.KeyPressed(key);
     } else {
-        // If neither is selected, all buttons/directions read as unpressed (high)
-        joypadOutput |= 0x0F;
+        joypad.KeyReleased(key);
     }
-    return joypadOutput;
+    checkJoypadInterrupt();
 }
-void Emulator::KeyPressed(int key) {
-     std::lock_guard<std::mutex> lock(inputMutex); // Lock joypad state access
-    bool previouslyUnset = (joypad.GetJoypadState() & (1 << key)) != 0;
 
-    // Set the bit in joypadState to 0 (pressed)
-    joypad.KeyPressed(key);
+// Raise the joypad interrupt for keys pressed since the last check that sit
+// in a column the guest has selected. Called at scheduler boundaries, so a
+// key published by the UI thread interrupts within one event slice.
+void Emulator::checkJoypadInterrupt() {
+    BYTE newPresses = joypad.takeNewPresses();
+    if (!newPresses || !cpu) {
+        return;
+    }
+    BYTE joypadRequest = memoryController->state().ioRegister(JOYPAD_REGISTER);
+    BYTE selected = 0;
+    if (!(joypadRequest & JOYPAD_SELECT_DIRECTIONS)) selected |= 0x0F; // Right, Left, Up, Down
+    if (!(joypadRequest & JOYPAD_SELECT_BUTTONS)) selected |= 0xF0;    // A, B, Select, Start
+    if (newPresses & selected) {
+        cpu->RequestInterrupt(JOYPAD_INTERRUPT_BIT);
+        LOG_DEBUG("Joypad interrupt requested for keys: " + std::to_string(newPresses & selected));
+    }
+}
 
-    // Determine if the pressed key belongs to the currently selected group
-    BYTE joypadRequest = memoryController->read(JOYPAD_REGISTER);
-    bool buttonColumnSelected = !(joypadRequest & JOYPAD_SELECT_BUTTONS);
-    bool directionColumnSelected = !(joypadRequest & JOYPAD_SELECT_DIRECTIONS);
+void Emulator::setDeterministic(bool enabled) {
+    if (emulationActive.load()) {
+        LOG_ERROR("Cannot switch deterministic mode while emulation is running");
+        return;
+    }
+    deterministic.store(enabled);
+    LOG_INFO(std::string("Deterministic mode ") + (enabled ? "enabled" : "disabled"));
+}
 
-    bool isButton = (key >= JOYPAD_A); // A, B, Select, Start
-    bool isDirection = !isButton;      // Right, Left, Up, Down
+bool Emulator::stepFrame() {
+    if (!loaded || emulationActive.load()) {
+        LOG_ERROR("stepFrame needs a loaded game and a stopped emulation thread");
+        return false;
+    }
+    const uint64_t frameEnd = (getCycle() / FRAME_CYCLES + 1) * FRAME_CYCLES;
+    ppu->setSkipRendering(false);
+    bool finished = runUntil(frameEnd);
+    ppu->catchUp();
+    memoryController->endProfilerFrame();
+    return finished;
+}
 
-    bool requestInterrupt = false;
-    if ((isButton && buttonColumnSelected) || (isDirection && directionColumnSelected)) {
-        requestInterrupt = true;
+bool Emulator::stepCycles(uint64_t cycles) {
+    if (!loaded || emulationActive.load()) {
+        LOG_ERROR("stepCycles needs a loaded game and a stopped emulation thread");
+        return false;
     }
+    bool finished = runUntil(getCycle() + cycles);
+    ppu->catchUp();  // Present every line of the slice, observed or not
+    memoryController->endProfilerFrame();
+    return finished;
+}
 
+void Emulator::scheduleInput(uint64_t cycle, int key, bool pressed) {
+    if (key < JOYPAD_RIGHT || key > JOYPAD_START) {
+        LOG_WARNING("Ignoring input for invalid key " + std::to_string(key));
+        return;
+    }
+    InputEvent event{cycle, static_cast<BYTE>(key), pressed};
+    // Keep the queue sorted; events on the same cycle stay in call order
+    auto position = std::upper_bound(scheduledInputs.begin(), scheduledInputs.end(), event,
+        [](const InputEvent& a, const InputEvent& b) { return a.cycle < b.cycle; });
+    scheduledInputs.insert(position, event);
+}
 
-    // Request interrupt only if the selected group had a key pressed
-    // and that specific key was previously unpressed.
-    if (requestInterrupt && previouslyUnset) {
-        // Request Joypad Interrupt (Bit 4 of IF register)
-        if (cpu) { // Check if CPU exists
-             cpu->RequestInterrupt(JOYPAD_INTERRUPT_BIT);
-             LOG_DEBUG("Joypad interrupt requested for key: " + std::to_string(key));
-        }
+bool Emulator::loadInputLog(const std::string& path) {
+    std::vector<InputEvent> events;
+    if (!::loadInputLog(path, events)) {
+        return false;
+    }
+    for (const InputEvent& event : events) {
+        scheduleInput(event.cycle, event.key, event.pressed);
     }
+    return true;
 }
-void Emulator::KeyReleased(int key) {
-     std::lock_guard<std::mutex> lock(inputMutex); // Lock joypad state access
-    joypad.KeyReleased(key);
+
+bool Emulator::saveInputLog(const std::string& path) const {
+    return ::saveInputLog(path, appliedInputs);
 }
 
+// Scheduled inputs are recorded with the cycle they were scheduled for: a
+// replay then splits the run at the same points
+void Emulator::applyDueInputs() {
+    const uint64_t now = memoryController->scheduler().now();
+    while (!scheduledInputs.empty() && scheduledInputs.front().cycle <= now) {
+        InputEvent event = scheduledInputs.front();
+        scheduledInputs.pop_front();
+        applyInput(event.key, event.pressed);
+        appliedInputs.push_back(event);
+    }
+}
 
+uint64_t Emulator::getCycle() const {
+    return memoryController ? memoryController->scheduler().now() : 0;
+}
 
+uint64_t Emulator::getStateHash() const {
+    if (!memoryController || !ppu) {
+        return 0;
+    }
+    uint64_t hash = hashMachineState(memoryController->state());
+    // Shade indices: the colour scheme is a display setting, not machine state
+    for (BYTE shade : ppu->getLastFrame().shades) {
+        hash ^= shade;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
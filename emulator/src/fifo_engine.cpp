@@ -0,0 +1,235 @@
+#include <ppu_engine.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int FIRST_FETCH_DOTS = 6;     // The line's first tile fetch is thrown away
+constexpr int FETCH_PUSH = 6;           // Fetcher steps 0-5 read VRAM, step 6 waits for an empty FIFO
+constexpr int OBJ_FETCH_DOTS = 6;
+constexpr int MAX_TRANSFER_CYCLES = SCANLINE_CYCLES - MODE_2_CYCLES - 1;
+}
+
+FifoEngine::FifoEngine(const PPURenderContext& context)
+    : m_Context(context)
+    , m_Line{}
+    , m_Drawing(false)
+    , m_WindowYHit(false)
+    , m_WindowLine(0)
+    , m_WindowUsed(false)
+{
+}
+
+// The length comes from a dry run of the line with the registers and sprites
+// as they are when mode 3 starts. The drawn run reads the registers live, so
+// a mid-line write changes pixels but not the HBlank point already scheduled.
+int FifoEngine::transferCycles(int line) {
+    if (line == 0) {
+        m_WindowYHit = false;
+        m_WindowLine = 0;
+    } else if (m_WindowUsed) {
+        m_WindowLine++;
+    }
+    m_WindowUsed = false;
+    if (m_Context.reg(WY_REGISTER) == line) {
+        m_WindowYHit = true;
+    }
+
+    LineState dry;
+    startLine(dry, line);
+    while (dry.x < SCREEN_PIXELS_WIDTH && dry.dot < MAX_TRANSFER_CYCLES) {
+        step(dry, false);
+    }
+    m_WindowUsed = dry.inWindow;
+    // Mode 3 ends on the dot after the last pixel leaves the FIFO
+    return std::min(dry.dot + 1, MAX_TRANSFER_CYCLES);
+}
+
+void FifoEngine::beginLine(int line) {
+    startLine(m_Line, line);
+    m_Drawing = true;
+}
+
+void FifoEngine::advance(int dots) {
+    if (m_Drawing) {
+        runTo(dots);
+    }
+}
+
+void FifoEngine::endLine() {
+    if (m_Drawing) {
+        runTo(SCANLINE_CYCLES);
+        m_Drawing = false;
+    }
+}
+
+void FifoEngine::runTo(int dots) {
+    while (m_Line.x < SCREEN_PIXELS_WIDTH && m_Line.dot < dots) {
+        step(m_Line, true);
+    }
+}
+
+void FifoEngine::startLine(LineState& state, int line) const {
+    memset(&state, 0, sizeof(state));
+    state.line = line;
+    state.discard = m_Context.reg(SCX_REGISTER) & 0x07;
+    int spriteHeight = (m_Context.reg(LCD_CONTROL) & 0x04) ? 16 : 8;
+    const SpriteLine& sprites = m_Context.sprites.line(line, spriteHeight);
+    state.spriteCount = sprites.count;
+    memcpy(state.sprites, sprites.sprites, sprites.count);
+    state.fetchStep = -FIRST_FETCH_DOTS;
+    state.windowLine = m_WindowLine;
+}
+
+// One dot of mode 3
+void FifoEngine::step(LineState& state, bool draw) const {
+    state.dot++;
+    if (state.spriteFetch > 0) {
+        // BG fetcher and pixel output are stalled until the object is in the OBJ FIFO
+        if (--state.spriteFetch == 0) {
+            loadSprite(state, state.sprites[state.nextSprite++]);
+        }
+        return;
+    }
+
+    BYTE lcdControl = m_Context.reg(LCD_CONTROL);
+
+    // Reaching WX - 7 restarts the fetcher on the window map with an empty FIFO
+    if (!state.inWindow && (lcdControl & 0x20) && m_WindowYHit && state.fetchStep >= 0 &&
+        state.discard == 0 && state.x + 7 >= m_Context.reg(WX_REGISTER)) {
+        state.inWindow = true;
+        state.bgCount = 0;
+        state.fetchStep = 0;
+        state.fetchX = 0;
+    }
+
+    tickFetcher(state);
+    if (state.bgCount == 0) {
+        return;
+    }
+
+    // An object starting at this pixel: the BG fetch in progress completes
+    // (the fetcher keeps ticking above), then the object is fetched while
+    // output waits. Objects disabled in LCDC cost nothing.
+    while (state.discard == 0 && state.nextSprite < state.spriteCount &&
+           m_Context.oam[state.sprites[state.nextSprite] * SPRITE_ATTRIBUTE_SIZE + SPRITE_X_POS] <= state.x + 8) {
+        if (!(lcdControl & 0x02)) {
+            state.nextSprite++;
+            continue;
+        }
+        if (state.fetchStep >= FETCH_PUSH) {
+            state.spriteFetch = OBJ_FETCH_DOTS - 1;  // This dot is the first
+        }
+        return;
+    }
+
+    BYTE bgIndex = state.bg[state.bgHead++];
+    state.bgCount--;
+    BYTE objColor = 0;
+    BYTE objAttributes = 0;
+    if (state.objCount > 0) {
+        objColor = state.objColor[0];
+        objAttributes = state.objAttributes[0];
+        memmove(state.objColor, state.objColor + 1, TILE_WIDTH - 1);
+        memmove(state.objAttributes, state.objAttributes + 1, TILE_WIDTH - 1);
+        state.objColor[TILE_WIDTH - 1] = 0;
+        state.objCount--;
+    }
+    if (state.discard > 0) {
+        state.discard--;
+        return;
+    }
+
+    if (draw) {
+        BYTE shade = 0;
+        if (lcdControl & 0x01) {
+            shade = m_Context.bgShades[bgIndex];
+        } else {
+            bgIndex = 0;
+        }
+        bool objectWins = objColor != 0 && (lcdControl & 0x02) &&
+                          !((objAttributes & SPRITE_PRIORITY) && bgIndex != 0);
+        if (objectWins) {
+            shade = m_Context.objShades[(objAttributes & SPRITE_PALETTE) ? 1 : 0][objColor];
+        }
+        m_Context.line(state.line)[state.x] = shade;
+    }
+    state.x++;
+}
+
+// Tile number on step 0, tile data on step 4 (both planes at once from the
+// decoded row), push on the first dot from step 5 on that finds the FIFO empty
+void FifoEngine::tickFetcher(LineState& state) const {
+    if (state.fetchStep < 0) {
+        state.fetchStep++;
+        return;
+    }
+    if (state.fetchStep < FETCH_PUSH) {
+        BYTE lcdControl = m_Context.reg(LCD_CONTROL);
+        if (state.fetchStep == 0) {
+            WORD tileMap;
+            int mapX;
+            int mapY;
+            if (state.inWindow) {
+                tileMap = (lcdControl & 0x40) ? WINDOW_TILE_MAP_2 : WINDOW_TILE_MAP_1;
+                mapX = state.fetchX & 31;
+                mapY = state.windowLine & 0xFF;
+            } else {
+                tileMap = (lcdControl & 0x08) ? BG_TILE_MAP_2 : BG_TILE_MAP_1;
+                mapX = ((m_Context.reg(SCX_REGISTER) >> 3) + state.fetchX) & 31;
+                mapY = (state.line + m_Context.reg(SCY_REGISTER)) & 0xFF;
+            }
+            state.tileEntry = m_Context.vram[(tileMap - 0x8000) + (mapY / TILE_HEIGHT) * 32 + mapX];
+        } else if (state.fetchStep == 4) {
+            int row = state.inWindow ? state.windowLine % TILE_HEIGHT
+                                     : (state.line + m_Context.reg(SCY_REGISTER)) % TILE_HEIGHT;
+            int tile = TileCache::tileNumber(state.tileEntry, (lcdControl & 0x10) != 0);
+            memcpy(state.fetched, m_Context.tiles.row(tile, row), TILE_WIDTH);
+        }
+        if (++state.fetchStep < FETCH_PUSH) {
+            return;
+        }
+    }
+    if (state.bgCount == 0) {
+        memcpy(state.bg, state.fetched, TILE_WIDTH);
+        state.bgHead = 0;
+        state.bgCount = TILE_WIDTH;
+        state.fetchX++;
+        state.fetchStep = 0;
+    }
+}
+
+// Mixes the object's row into the OBJ FIFO. Pixels already there came from
+// sprites earlier in priority order and stay unless they are transparent.
+void FifoEngine::loadSprite(LineState& state, BYTE sprite) const {
+    const BYTE* attributes = m_Context.oam.data() + sprite * SPRITE_ATTRIBUTE_SIZE;
+    BYTE flags = attributes[SPRITE_ATTRIBUTES];
+    int spriteHeight = (m_Context.reg(LCD_CONTROL) & 0x04) ? 16 : 8;
+    int row = state.line - (attributes[SPRITE_Y_POS] - 16);
+    if (row < 0 || row >= spriteHeight) {
+        return;  // OBJ size changed since the OAM scan
+    }
+    if (flags & SPRITE_Y_FLIP) {
+        row = spriteHeight - 1 - row;
+    }
+    BYTE tileIndex = attributes[SPRITE_TILE_INDEX];
+    if (spriteHeight == 16) {
+        tileIndex &= 0xFE;
+        if (row >= 8) {
+            tileIndex |= 0x01;
+            row -= 8;
+        }
+    }
+    const BYTE* pixels = m_Context.tiles.row(tileIndex, row);
+
+    // Columns left of the current pixel (X < 8 at the screen edge) are dropped
+    int skip = std::max(0, state.x + 8 - attributes[SPRITE_X_POS]);
+    for (int column = skip; column < TILE_WIDTH; column++) {
+        int slot = column - skip;
+        BYTE color = pixels[(flags & SPRITE_X_FLIP) ? TILE_WIDTH - 1 - column : column];
+        if (state.objColor[slot] == 0 && color != 0) {
+            state.objColor[slot] = color;
+            state.objAttributes[slot] = flags;
+        }
+    }
+    state.objCount = std::max(state.objCount, TILE_WIDTH - skip);
+}
@@ -0,0 +1,239 @@
+#include <frame_pacer.h>
+#include <logger.h>
+#include <numeric>
+#include <thread>
+#include <chrono>
+#if defined(_WIN32) || defined(__APPLE__)
+#define FRAME_PACER_PORTABLE_SLEEP
+#else
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace {
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr int64_t STATS_WINDOW_NS = NS_PER_SECOND;
+constexpr int MAX_LAG_FRAMES = 4;   // Further behind than this: drop the debt instead of bursting
+constexpr int MAX_AUTO_SKIP = 4;    // AUTO still draws at least one frame in five
+constexpr int AUTO_RECOVER_FRAMES = 120;  // On-time frames before AUTO skips one frame less
+constexpr int64_t DISPLAY_INTERVAL_NS = NS_PER_SECOND / 60;
+#ifdef FRAME_PACER_PORTABLE_SLEEP
+constexpr int64_t SPIN_TAIL_NS = 2000000;  // Sleep granularity is coarse - spin the last 2 ms
+#else
+constexpr int64_t SPIN_TAIL_NS = 200000;
+#endif
+
+uint64_t packSpeed(uint32_t numerator, uint32_t denominator) {
+    return (static_cast<uint64_t>(numerator) << 32) | denominator;
+}
+}
+
+FramePacer::FramePacer()
+    : m_OriginNs(0)
+    , m_OriginCycle(0)
+    , m_FrameEnd(FRAME_CYCLES)
+    , m_Numerator(1)
+    , m_Denominator(1)
+    , m_PendingSpeed(0)
+    , m_FrameskipMode(FrameskipMode::AUTO)
+    , m_FixedSkip(0)
+    , m_AutoSkip(0)
+    , m_SkipCountdown(0)
+    , m_OnTimeStreak(0)
+    , m_LastRenderNs(0)
+    , m_WindowStartNs(0)
+    , m_WindowStartCycle(0)
+    , m_WindowFrames(0)
+    , m_WindowLate(0)
+    , m_WindowSkipped(0)
+    , m_Stats{}
+{
+    restart(0);
+}
+
+void FramePacer::setSpeed(uint32_t numerator, uint32_t denominator) {
+    if (denominator == 0) {
+        LOG_WARNING("Invalid emulation speed ratio " + std::to_string(numerator) + "/0");
+        return;
+    }
+    uint32_t divisor = std::gcd(numerator, denominator);
+    if (numerator == 0) {
+        denominator = 1;
+    } else {
+        numerator /= divisor;
+        denominator /= divisor;
+    }
+    m_PendingSpeed.store(packSpeed(numerator, denominator));
+}
+
+void FramePacer::restart(uint64_t cycle) {
+    uint64_t pending = m_PendingSpeed.exchange(0);
+    if (pending != 0) {
+        m_Numerator = static_cast<uint32_t>(pending >> 32);
+        m_Denominator = static_cast<uint32_t>(pending);
+    }
+    m_OriginNs = nowNs();
+    m_OriginCycle = cycle;
+    m_FrameEnd = cycle + FRAME_CYCLES;
+    m_WindowStartNs = m_OriginNs;
+    m_WindowStartCycle = cycle;
+    m_WindowFrames = 0;
+    m_WindowLate = 0;
+    m_WindowSkipped = 0;
+}
+
+void FramePacer::setFrameskip(FrameskipMode mode, int fixedSkip) {
+    m_FixedSkip.store(fixedSkip > 0 ? fixedSkip : 0);
+    m_FrameskipMode.store(mode);
+}
+
+bool FramePacer::shouldRenderFrame() {
+    FrameskipMode mode = m_FrameskipMode.load();
+    bool render = true;
+    if (mode == FrameskipMode::AUTO && (isUncapped() || m_Numerator > m_Denominator)) {
+        // Fast-forward: frames are produced faster than they can be shown
+        render = nowNs() - m_LastRenderNs >= DISPLAY_INTERVAL_NS;
+    } else if (mode != FrameskipMode::OFF) {
+        if (m_SkipCountdown > 0) {
+            m_SkipCountdown--;
+            render = false;
+        } else {
+            m_SkipCountdown = (mode == FrameskipMode::AUTO) ? m_AutoSkip : m_FixedSkip.load();
+        }
+    }
+
+    if (render) {
+        m_LastRenderNs = nowNs();
+    } else {
+        m_WindowSkipped++;
+    }
+    return render;
+}
+
+// origin + (cycle - originCycle) / CPU_CLOCK_SPEED * denominator / numerator seconds,
+// split into whole and fractional seconds so the product cannot overflow
+int64_t FramePacer::deadlineFor(uint64_t cycle) const {
+    uint64_t scaled = (cycle - m_OriginCycle) * m_Denominator;
+    uint64_t divisor = static_cast<uint64_t>(CPU_CLOCK_SPEED) * m_Numerator;
+    uint64_t seconds = scaled / divisor;
+    uint64_t remainder = scaled % divisor;
+    return m_OriginNs + static_cast<int64_t>(seconds) * NS_PER_SECOND
+                      + static_cast<int64_t>(remainder * NS_PER_SECOND / divisor);
+}
+
+bool FramePacer::endFrame(uint64_t cycle) {
+    int64_t wallNow = nowNs();
+    if (!isUncapped()) {
+        int64_t deadline = deadlineFor(m_FrameEnd);
+        if (wallNow <= deadline) {
+            sleepUntil(deadline);
+            wallNow = nowNs();
+            if (m_AutoSkip > 0 && ++m_OnTimeStreak >= AUTO_RECOVER_FRAMES) {
+                m_AutoSkip--;
+                m_OnTimeStreak = 0;
+            }
+        } else {
+            m_WindowLate++;
+            m_OnTimeStreak = 0;
+            if (m_AutoSkip < MAX_AUTO_SKIP) {
+                m_AutoSkip++;
+            }
+            int64_t frameNs = deadlineFor(m_OriginCycle + FRAME_CYCLES) - m_OriginNs;
+            if (wallNow - deadline > MAX_LAG_FRAMES * frameNs) {
+                // Re-base instead of running flat out until the backlog is gone
+                m_OriginNs = wallNow;
+                m_OriginCycle = m_FrameEnd;
+            }
+        }
+    }
+    m_WindowFrames++;
+
+    uint64_t boundary = m_FrameEnd;
+    while (m_FrameEnd <= cycle) {
+        m_FrameEnd += FRAME_CYCLES;
+    }
+    applyPendingSpeed(boundary, wallNow);
+
+    if (wallNow - m_WindowStartNs >= STATS_WINDOW_NS) {
+        PacingStats stats;
+        double seconds = static_cast<double>(wallNow - m_WindowStartNs) / NS_PER_SECOND;
+        {
+            std::lock_guard<std::mutex> lock(m_StatsMutex);
+            stats = m_Stats;
+        }
+        stats.fps = m_WindowFrames / seconds;
+        stats.speed = static_cast<double>(cycle - m_WindowStartCycle) / (seconds * CPU_CLOCK_SPEED);
+        stats.lateFrames = m_WindowLate;
+        stats.skippedFrames = m_WindowSkipped;
+        stats.totalFrames += m_WindowFrames;
+        stats.totalLateFrames += m_WindowLate;
+        stats.totalSkippedFrames += m_WindowSkipped;
+        {
+            std::lock_guard<std::mutex> lock(m_StatsMutex);
+            m_Stats = stats;
+        }
+        m_WindowStartNs = wallNow;
+        m_WindowStartCycle = cycle;
+        m_WindowFrames = 0;
+        m_WindowLate = 0;
+        m_WindowSkipped = 0;
+        return true;
+    }
+    return false;
+}
+
+// A new ratio starts a new timeline at the frame boundary just passed
+void FramePacer::applyPendingSpeed(uint64_t cycle, int64_t wallNow) {
+    uint64_t pending = m_PendingSpeed.exchange(0);
+    if (pending == 0) {
+        return;
+    }
+    m_Numerator = static_cast<uint32_t>(pending >> 32);
+    m_Denominator = static_cast<uint32_t>(pending);
+    m_OriginNs = wallNow;
+    m_OriginCycle = cycle;
+}
+
+PacingStats FramePacer::stats() const {
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_Stats;
+}
+
+#ifdef FRAME_PACER_PORTABLE_SLEEP
+int64_t FramePacer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::sleepUntil(int64_t deadlineNs) {
+    int64_t coarse = deadlineNs - SPIN_TAIL_NS;
+    if (coarse > nowNs()) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(coarse))));
+    }
+    while (nowNs() < deadlineNs) {
+        std::this_thread::yield();
+    }
+}
+#else
+int64_t FramePacer::nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec;
+}
+
+// Absolute sleep: a late wake-up does not push the following deadlines back
+void FramePacer::sleepUntil(int64_t deadlineNs) {
+    int64_t coarse = deadlineNs - SPIN_TAIL_NS;
+    if (coarse > nowNs()) {
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(coarse / NS_PER_SECOND);
+        ts.tv_nsec = static_cast<long>(coarse % NS_PER_SECOND);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+    }
+    while (nowNs() < deadlineNs) {
+        std::this_thread::yield();
+    }
+}
+#endif
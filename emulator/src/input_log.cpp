@@ -0,0 +1,54 @@
+#include <input_log.h>
+#include <logger.h>
+#include <fstream>
+#include <sstream>
+
+bool loadInputLog(const std::string& path, std::vector<InputEvent>& events) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open input log: " + path);
+        return false;
+    }
+
+    std::vector<InputEvent> loaded;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        uint64_t cycle = 0;
+        int key = -1;
+        int pressed = -1;
+        if (!(fields >> cycle >> key >> pressed) || key < JOYPAD_RIGHT || key > JOYPAD_START ||
+            (pressed != 0 && pressed != 1)) {
+            LOG_ERROR(path + ":" + std::to_string(lineNumber) + ": expected '<cycle> <key 0-7> <0|1>'");
+            return false;
+        }
+        if (!loaded.empty() && cycle < loaded.back().cycle) {
+            LOG_ERROR(path + ":" + std::to_string(lineNumber) + ": events are not sorted by cycle");
+            return false;
+        }
+        loaded.push_back({cycle, static_cast<BYTE>(key), pressed == 1});
+    }
+
+    events = std::move(loaded);
+    LOG_INFO("Loaded " + std::to_string(events.size()) + " input events from " + path);
+    return true;
+}
+
+bool saveInputLog(const std::string& path, const std::vector<InputEvent>& events) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open input log for writing: " + path);
+        return false;
+    }
+    file << "# cycle key pressed\n";
+    for (const InputEvent& event : events) {
+        file << event.cycle << ' ' << static_cast<int>(event.key) << ' ' << (event.pressed ? 1 : 0) << '\n';
+    }
+    return static_cast<bool>(file);
+}
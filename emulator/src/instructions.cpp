@@ -54,7 +54,8 @@ void set_reg_pair_val(CPU& cpu, GB::Register reg_enum, WORD value) {
 // --- Instruction Implementations ---
 
 // Group: CONTROL_MISC
-int NOP_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int NOP_impl(Core& cpu, const OpcodeInfo& info) {
     // NOP: No operation.
     // Flags: Z N H C
     //        - - - -
@@ -62,7 +63,8 @@ int NOP_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int HALT_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int HALT_impl(Core& cpu, const OpcodeInfo& info) {
     // HALT: Power down CPU until an interrupt occurs.
     // If IME is 0 and IF&IE is non-zero, a HALT bug occurs.
     // For now, just set the halt state. Interrupt handling will wake it.
@@ -85,7 +87,8 @@ int HALT_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int STOP_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int STOP_impl(Core& cpu, const OpcodeInfo& info) {
     // STOP: Halt CPU and LCD until a button is pressed.
     // Consumes a 0x00 byte after it (which is part of its 2-byte length in OpcodeInfo).
     // The OpcodeInfo length should be 2, and CPU::readBytePC would have consumed the 0x00.
@@ -96,14 +99,16 @@ int STOP_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int DI_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int DI_impl(Core& cpu, const OpcodeInfo& info) {
     // DI: Disable interrupts (clear IME flag).
     // Flags: - - - -
     cpu.disableInterrupts();
     return info.cycles[0];
 }
 
-int EI_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int EI_impl(Core& cpu, const OpcodeInfo& info) {
     // EI: Enable interrupts. Takes effect after the instruction *following* EI.
     // Flags: - - - -
     cpu.scheduleInterruptEnable();
@@ -111,7 +116,8 @@ int EI_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 // --- 8-bit Load Instructions ---
-int LD_reg_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_reg_reg_impl(Core& cpu, const OpcodeInfo& info) {
     // LD r, r' : Load value from register r' into register r.
     // Example: LD B, C (info.operand1 = Register::B, info.operand2 = Register::C)
     // Flags: - - - -
@@ -121,7 +127,8 @@ int LD_reg_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_reg_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_reg_n8_impl(Core& cpu, const OpcodeInfo& info) {
     // LD r, n8 : Load immediate 8-bit value n8 into register r.
     // Example: LD B, 0x05 (info.operand1 = Register::B, n8 is read from PC)
     // Flags: - - - -
@@ -130,7 +137,8 @@ int LD_reg_n8_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_reg_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_reg_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     // LD r, (HL) : Load value from memory address pointed by HL into register r.
     // Example: LD B, (HL) (info.operand1 = Register::B)
     // Flags: - - - -
@@ -139,7 +147,8 @@ int LD_reg_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_memHL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memHL_reg_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (HL), r : Store value from register r into memory address pointed by HL.
     // Example: LD (HL), B (info.operand2 = Register::B)
     // Flags: - - - -
@@ -148,7 +157,8 @@ int LD_memHL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_memHL_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memHL_n8_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (HL), n8 : Store immediate 8-bit value n8 into memory address pointed by HL.
     // Flags: - - - -
     BYTE immediate_val = cpu.readBytePC(); // n8 is the byte after the opcode
@@ -156,21 +166,24 @@ int LD_memHL_n8_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_A_memBC_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_A_memBC_impl(Core& cpu, const OpcodeInfo& info) {
     // LD A, (BC)
     // Flags: - - - -
     cpu.getA() = cpu.readMemory(cpu.getBC());
     return info.cycles[0];
 }
 
-int LD_A_memDE_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_A_memDE_impl(Core& cpu, const OpcodeInfo& info) {
     // LD A, (DE)
     // Flags: - - - -
     cpu.getA() = cpu.readMemory(cpu.getDE());
     return info.cycles[0];
 }
 
-int LD_A_memA16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_A_memA16_impl(Core& cpu, const OpcodeInfo& info) {
     // LD A, (a16)
     // Flags: - - - -
     WORD address = cpu.readWordPC(); // a16 is the two bytes after the opcode
@@ -178,21 +191,24 @@ int LD_A_memA16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_memBC_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memBC_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (BC), A
     // Flags: - - - -
     cpu.writeMemory(cpu.getBC(), cpu.getA());
     return info.cycles[0];
 }
 
-int LD_memDE_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memDE_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (DE), A
     // Flags: - - - -
     cpu.writeMemory(cpu.getDE(), cpu.getA());
     return info.cycles[0];
 }
 
-int LD_memA16_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memA16_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (a16), A
     // Flags: - - - -
     WORD address = cpu.readWordPC(); // a16 is the two bytes after the opcode
@@ -200,7 +216,8 @@ int LD_memA16_A_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LDH_memA8_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LDH_memA8_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LDH (a8), A  : LD (0xFF00 + a8), A
     // Flags: - - - -
     BYTE offset = cpu.readBytePC(); // a8 is the byte after the opcode
@@ -208,7 +225,8 @@ int LDH_memA8_A_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LDH_A_memA8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LDH_A_memA8_impl(Core& cpu, const OpcodeInfo& info) {
     // LDH A, (a8)  : LD A, (0xFF00 + a8)
     // Flags: - - - -
     BYTE offset = cpu.readBytePC(); // a8 is the byte after the opcode
@@ -216,21 +234,24 @@ int LDH_A_memA8_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LDH_memC_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LDH_memC_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LDH (C), A   : LD (0xFF00 + C), A
     // Flags: - - - -
     cpu.writeMemory(0xFF00 + cpu.getC(), cpu.getA());
     return info.cycles[0];
 }
 
-int LDH_A_memC_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LDH_A_memC_impl(Core& cpu, const OpcodeInfo& info) {
     // LDH A, (C)   : LD A, (0xFF00 + C)
     // Flags: - - - -
     cpu.getA() = cpu.readMemory(0xFF00 + cpu.getC());
     return info.cycles[0];
 }
 
-int LD_A_memHLI_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_A_memHLI_impl(Core& cpu, const OpcodeInfo& info) {
     // LD A, (HL+) : LD A, (HL) then HL = HL + 1
     // Flags: - - - -
     cpu.getA() = cpu.readMemory(cpu.getHL());
@@ -238,7 +259,8 @@ int LD_A_memHLI_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_A_memHLD_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_A_memHLD_impl(Core& cpu, const OpcodeInfo& info) {
     // LD A, (HL-) : LD A, (HL) then HL = HL - 1
     // Flags: - - - -
     cpu.getA() = cpu.readMemory(cpu.getHL());
@@ -246,7 +268,8 @@ int LD_A_memHLD_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_memHLI_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memHLI_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (HL+), A : LD (HL), A then HL = HL + 1
     // Flags: - - - -
     cpu.writeMemory(cpu.getHL(), cpu.getA());
@@ -254,7 +277,8 @@ int LD_memHLI_A_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_memHLD_A_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memHLD_A_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (HL-), A : LD (HL), A then HL = HL - 1
     // Flags: - - - -
     cpu.writeMemory(cpu.getHL(), cpu.getA());
@@ -264,7 +288,8 @@ int LD_memHLD_A_impl(CPU& cpu, const OpcodeInfo& info) {
 
 
 // --- 16-bit Load Instructions ---
-int LD_rr_n16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_rr_n16_impl(Core& cpu, const OpcodeInfo& info) {
     // LD rr, n16 : Load immediate 16-bit value n16 into register pair rr.
     // rr can be BC, DE, HL, SP.
     // Flags: - - - -
@@ -273,14 +298,16 @@ int LD_rr_n16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int LD_SP_HL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_SP_HL_impl(Core& cpu, const OpcodeInfo& info) {
     // LD SP, HL
     // Flags: - - - -
     cpu.setSP(cpu.getHL());
     return info.cycles[0]; // Typically 8 cycles
 }
 
-int LD_memA16_SP_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_memA16_SP_impl(Core& cpu, const OpcodeInfo& info) {
     // LD (a16), SP : Store SP at address a16.
     // (a16) is LSB, (a16+1) is MSB of SP.
     // Flags: - - - -
@@ -291,7 +318,8 @@ int LD_memA16_SP_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // Typically 20 cycles
 }
 
-int LD_HL_SP_e8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int LD_HL_SP_e8_impl(Core& cpu, const OpcodeInfo& info) {
     // LD HL, SP+e8 : Load SP + signed immediate e8 into HL.
     // Flags: Z N H C
     //        0 0 H C (H and C are set according to 8-bit addition of SP_lo and e8)
@@ -316,7 +344,8 @@ int LD_HL_SP_e8_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 
-int PUSH_rr_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int PUSH_rr_impl(Core& cpu, const OpcodeInfo& info) {
     // PUSH rr : Push register pair rr onto the stack.
     // rr can be AF, BC, DE, HL.
     // Flags: - - - -
@@ -326,7 +355,8 @@ int PUSH_rr_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // Typically 16 cycles
 }
 
-int POP_rr_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int POP_rr_impl(Core& cpu, const OpcodeInfo& info) {
     // POP rr : Pop value from stack into register pair rr.
     // rr can be AF, BC, DE, HL.
     // Flags: Z N H C (if rr is AF, flags are set from popped value, lower bits masked)
@@ -356,27 +386,33 @@ void alu_add_base(CPU& cpu, BYTE value, bool with_carry) {
     cpu.getA() = static_cast<BYTE>(result & 0xFF);
 }
 
-int ADD_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADD_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, get_reg_ref(cpu, info.operand2), false);
     return info.cycles[0];
 }
-int ADD_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADD_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, cpu.readBytePC(), false);
     return info.cycles[0];
 }
-int ADD_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADD_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, cpu.readMemory(cpu.getHL()), false);
     return info.cycles[0];
 }
-int ADC_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADC_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, get_reg_ref(cpu, info.operand2), true);
     return info.cycles[0];
 }
-int ADC_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADC_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, cpu.readBytePC(), true);
     return info.cycles[0];
 }
-int ADC_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADC_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     alu_add_base(cpu, cpu.readMemory(cpu.getHL()), true);
     return info.cycles[0];
 }
@@ -400,32 +436,39 @@ void alu_sub_base(CPU& cpu, BYTE value, bool with_carry, bool is_cp) {
     }
 }
 
-int SUB_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SUB_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, get_reg_ref(cpu, info.operand2), false, false);
     return info.cycles[0];
 }
-int SUB_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SUB_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readBytePC(), false, false);
     return info.cycles[0];
 }
-int SUB_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SUB_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readMemory(cpu.getHL()), false, false);
     return info.cycles[0];
 }
-int SBC_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SBC_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, get_reg_ref(cpu, info.operand2), true, false);
     return info.cycles[0];
 }
-int SBC_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SBC_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readBytePC(), true, false);
     return info.cycles[0];
 }
-int SBC_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SBC_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readMemory(cpu.getHL()), true, false);
     return info.cycles[0];
 }
 
-int AND_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int AND_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() &= get_reg_ref(cpu, info.operand2);
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -433,7 +476,8 @@ int AND_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int AND_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int AND_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() &= cpu.readBytePC();
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -441,7 +485,8 @@ int AND_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int AND_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int AND_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() &= cpu.readMemory(cpu.getHL());
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -450,7 +495,8 @@ int AND_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int XOR_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int XOR_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() ^= get_reg_ref(cpu, info.operand2);
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -458,7 +504,8 @@ int XOR_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int XOR_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int XOR_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() ^= cpu.readBytePC();
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -466,7 +513,8 @@ int XOR_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int XOR_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int XOR_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() ^= cpu.readMemory(cpu.getHL());
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -475,7 +523,8 @@ int XOR_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int OR_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int OR_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() |= get_reg_ref(cpu, info.operand2);
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -483,7 +532,8 @@ int OR_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int OR_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int OR_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() |= cpu.readBytePC();
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -491,7 +541,8 @@ int OR_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int OR_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int OR_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     cpu.getA() |= cpu.readMemory(cpu.getHL());
     cpu.setFlagZ(cpu.getA() == 0);
     cpu.setFlagN(false);
@@ -500,15 +551,18 @@ int OR_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int CP_A_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CP_A_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, get_reg_ref(cpu, info.operand2), false, true); // true for is_cp
     return info.cycles[0];
 }
-int CP_A_n8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CP_A_n8_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readBytePC(), false, true);
     return info.cycles[0];
 }
-int CP_A_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CP_A_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     alu_sub_base(cpu, cpu.readMemory(cpu.getHL()), false, true);
     return info.cycles[0];
 }
@@ -522,11 +576,13 @@ void alu_inc8(CPU& cpu, BYTE& reg) {
     cpu.setFlagH((original_val & 0xF) == 0xF); // Half carry if LSN was 0xF
     // C flag is not affected
 }
-int INC_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int INC_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_inc8(cpu, get_reg_ref(cpu, info.operand1));
     return info.cycles[0];
 }
-int INC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int INC_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     BYTE original_val = val;
     val++;
@@ -554,11 +610,13 @@ void alu_dec8(CPU& cpu, BYTE& reg) {
     cpu.setFlagH((original_val & 0xF) == 0x0); // Half borrow if LSN was 0x0
     // C flag is not affected
 }
-int DEC_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int DEC_reg_impl(Core& cpu, const OpcodeInfo& info) {
     alu_dec8(cpu, get_reg_ref(cpu, info.operand1));
     return info.cycles[0];
 }
-int DEC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int DEC_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     BYTE original_val = val;
     val--;
@@ -572,7 +630,8 @@ int DEC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
 
 
 // --- 16-bit ALU Instructions ---
-int ADD_HL_rr_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADD_HL_rr_impl(Core& cpu, const OpcodeInfo& info) {
     // ADD HL, rr (rr = BC, DE, HL, SP)
     // Flags: Z N H C
     //        - 0 H C
@@ -590,7 +649,8 @@ int ADD_HL_rr_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int ADD_SP_e8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int ADD_SP_e8_impl(Core& cpu, const OpcodeInfo& info) {
     // ADD SP, e8 (e8 is signed immediate)
     // Flags: Z N H C
     //        0 0 H C (H and C are from LSB of SP + e8)
@@ -613,7 +673,8 @@ int ADD_SP_e8_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 
-int INC_rr_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int INC_rr_impl(Core& cpu, const OpcodeInfo& info) {
     // INC rr (rr = BC, DE, HL, SP)
     // Flags: - - - - (No flags affected for 16-bit INC/DEC)
     WORD val = get_reg_pair_val(cpu, info.operand1);
@@ -623,7 +684,8 @@ int INC_rr_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 8 cycles
 }
 
-int DEC_rr_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int DEC_rr_impl(Core& cpu, const OpcodeInfo& info) {
     // DEC rr (rr = BC, DE, HL, SP)
     // Flags: - - - -
     WORD val = get_reg_pair_val(cpu, info.operand1);
@@ -634,7 +696,8 @@ int DEC_rr_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 // --- Rotate and Shift Instructions (Non-CB) ---
-int RLCA_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RLCA_impl(Core& cpu, const OpcodeInfo& info) {
     // RLCA: Rotate A left. Bit 7 to Carry and to Bit 0.
     // Flags: Z N H C
     //        0 0 0 C
@@ -651,7 +714,8 @@ int RLCA_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int RLA_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RLA_impl(Core& cpu, const OpcodeInfo& info) {
     // RLA: Rotate A left through Carry.
     // Flags: Z N H C
     //        0 0 0 C
@@ -669,7 +733,8 @@ int RLA_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int RRCA_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RRCA_impl(Core& cpu, const OpcodeInfo& info) {
     // RRCA: Rotate A right. Bit 0 to Carry and to Bit 7.
     // Flags: Z N H C
     //        0 0 0 C
@@ -686,7 +751,8 @@ int RRCA_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int RRA_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RRA_impl(Core& cpu, const OpcodeInfo& info) {
     // RRA: Rotate A right through Carry.
     // Flags: Z N H C
     //        0 0 0 C
@@ -716,12 +782,14 @@ BYTE rlc_op(CPU& cpu, BYTE val) {
     cpu.setFlagC(carry);
     return val;
 }
-int RLC_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RLC_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     reg = rlc_op(cpu, reg);
     return info.cycles[0];
 }
-int RLC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RLC_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     val = rlc_op(cpu, val);
     cpu.writeMemory(cpu.getHL(), val);
@@ -739,12 +807,14 @@ BYTE rrc_op(CPU& cpu, BYTE val) {
     cpu.setFlagC(carry);
     return val;
 }
-int RRC_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RRC_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     reg = rrc_op(cpu, reg);
     return info.cycles[0];
 }
-int RRC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RRC_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     val = rrc_op(cpu, val);
     cpu.writeMemory(cpu.getHL(), val);
@@ -752,7 +822,8 @@ int RRC_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 
-int RL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RL_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     bool old_carry = cpu.getFlagC();
     bool new_carry = (reg & 0x80) != 0;
@@ -764,7 +835,8 @@ int RL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(new_carry);
     return info.cycles[0];
 }
-int RL_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RL_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     bool old_carry = cpu.getFlagC();
     bool new_carry = (val & 0x80) != 0;
@@ -778,7 +850,8 @@ int RL_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int RR_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RR_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     bool old_carry = cpu.getFlagC();
     bool new_carry = (reg & 0x01) != 0;
@@ -790,7 +863,8 @@ int RR_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(new_carry);
     return info.cycles[0];
 }
-int RR_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RR_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     bool old_carry = cpu.getFlagC();
     bool new_carry = (val & 0x01) != 0;
@@ -804,7 +878,8 @@ int RR_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SLA_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SLA_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     bool carry = (reg & 0x80) != 0;
     reg <<= 1;
@@ -814,7 +889,8 @@ int SLA_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(carry);
     return info.cycles[0];
 }
-int SLA_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SLA_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     bool carry = (val & 0x80) != 0;
     val <<= 1;
@@ -826,7 +902,8 @@ int SLA_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SRA_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SRA_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     bool carry = (reg & 0x01) != 0;
     BYTE msb = reg & 0x80; // Preserve MSB
@@ -838,7 +915,8 @@ int SRA_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(carry);
     return info.cycles[0];
 }
-int SRA_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SRA_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     bool carry = (val & 0x01) != 0;
     BYTE msb = val & 0x80;
@@ -852,7 +930,8 @@ int SRA_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SWAP_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SWAP_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     BYTE temp = (reg >> 4) | (reg << 4);
     reg = temp;
@@ -862,7 +941,8 @@ int SWAP_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(false);
     return info.cycles[0];
 }
-int SWAP_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SWAP_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     BYTE temp = (val >> 4) | (val << 4);
     cpu.writeMemory(cpu.getHL(), temp);
@@ -873,7 +953,8 @@ int SWAP_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SRL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SRL_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE& reg = get_reg_ref(cpu, info.operand1);
     bool carry = (reg & 0x01) != 0;
     reg >>= 1;
@@ -883,7 +964,8 @@ int SRL_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     cpu.setFlagC(carry);
     return info.cycles[0];
 }
-int SRL_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SRL_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE val = cpu.readMemory(cpu.getHL());
     bool carry = (val & 0x01) != 0;
     val >>= 1;
@@ -895,7 +977,8 @@ int SRL_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int BIT_b_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int BIT_b_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_test = info.extraData; // Bit number stored in extraData
     BYTE& reg_val = get_reg_ref(cpu, info.operand1);
     cpu.setFlagZ(!((reg_val >> bit_to_test) & 0x01));
@@ -905,7 +988,8 @@ int BIT_b_reg_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int BIT_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int BIT_b_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_test = info.extraData;
     BYTE mem_val = cpu.readMemory(cpu.getHL());
     cpu.setFlagZ(!((mem_val >> bit_to_test) & 0x01));
@@ -914,14 +998,16 @@ int BIT_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int RES_b_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RES_b_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_reset = info.extraData;
     BYTE& reg_val = get_reg_ref(cpu, info.operand1);
     reg_val &= ~(1 << bit_to_reset);
     // No flags affected by RES
     return info.cycles[0];
 }
-int RES_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RES_b_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_reset = info.extraData;
     BYTE mem_val = cpu.readMemory(cpu.getHL());
     mem_val &= ~(1 << bit_to_reset);
@@ -929,14 +1015,16 @@ int RES_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SET_b_reg_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SET_b_reg_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_set = info.extraData;
     BYTE& reg_val = get_reg_ref(cpu, info.operand1);
     reg_val |= (1 << bit_to_set);
     // No flags affected by SET
     return info.cycles[0];
 }
-int SET_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SET_b_memHL_impl(Core& cpu, const OpcodeInfo& info) {
     BYTE bit_to_set = info.extraData;
     BYTE mem_val = cpu.readMemory(cpu.getHL());
     mem_val |= (1 << bit_to_set);
@@ -946,7 +1034,8 @@ int SET_b_memHL_impl(CPU& cpu, const OpcodeInfo& info) {
 
 
 // --- Control/Branch Instructions ---
-int JP_n16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int JP_n16_impl(Core& cpu, const OpcodeInfo& info) {
     // JP a16 : Jump to address a16.
     // Flags: - - - -
     cpu.setPC(cpu.readWordPC());
@@ -954,7 +1043,8 @@ int JP_n16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 16 cycles
 }
 
-int JP_cc_n16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int JP_cc_n16_impl(Core& cpu, const OpcodeInfo& info) {
     // JP cc, a16 : Conditional jump to a16.
     // Flags: - - - -
     WORD new_pc = cpu.readWordPC();
@@ -974,14 +1064,16 @@ int JP_cc_n16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[1]; // e.g., 12 cycles if not taken
 }
 
-int JP_HL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int JP_HL_impl(Core& cpu, const OpcodeInfo& info) {
     // JP HL : Jump to address in HL. (Formerly JP (HL))
     // Flags: - - - -
     cpu.setPC(cpu.getHL());
     return info.cycles[0]; // Typically 4 cycles
 }
 
-int JR_e8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int JR_e8_impl(Core& cpu, const OpcodeInfo& info) {
     // JR e8 : Relative jump by signed e8.
     // Flags: - - - -
     signed char offset = static_cast<signed char>(cpu.readBytePC());
@@ -990,7 +1082,8 @@ int JR_e8_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 12 cycles
 }
 
-int JR_cc_e8_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int JR_cc_e8_impl(Core& cpu, const OpcodeInfo& info) {
     signed char offset = static_cast<signed char>(cpu.readBytePC());
     bool condition_met = false;
     int cycles = info.cycles[1]; // Default cycles for no jump
@@ -1040,7 +1133,8 @@ int JR_cc_e8_impl(CPU& cpu, const OpcodeInfo& info) {
     return cycles; // 8 cycles if no jump
 }
 
-int CALL_n16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CALL_n16_impl(Core& cpu, const OpcodeInfo& info) {
     // CALL a16 : Call subroutine at address a16.
     // Flags: - - - -
     WORD call_addr = cpu.readWordPC();
@@ -1050,7 +1144,8 @@ int CALL_n16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 24 cycles
 }
 
-int CALL_cc_n16_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CALL_cc_n16_impl(Core& cpu, const OpcodeInfo& info) {
     // CALL cc, a16 : Conditional call.
     // Flags: - - - -
     WORD call_addr = cpu.readWordPC();
@@ -1070,7 +1165,8 @@ int CALL_cc_n16_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[1]; // 12 cycles if no call
 }
 
-int RET_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RET_impl(Core& cpu, const OpcodeInfo& info) {
     // RET : Return from subroutine.
     // Flags: - - - -
     cpu.setPC(cpu.popStackWord());
@@ -1078,7 +1174,8 @@ int RET_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 16 cycles
 }
 
-int RET_cc_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RET_cc_impl(Core& cpu, const OpcodeInfo& info) {
     // RET cc : Conditional return.
     // Flags: - - - -
     bool condition_met = false;
@@ -1097,7 +1194,8 @@ int RET_cc_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[1]; // 8 cycles if no return
 }
 
-int RETI_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RETI_impl(Core& cpu, const OpcodeInfo& info) {
     // RETI : Return from interrupt and enable interrupts.
     // Flags: - - - -
     cpu.setPC(cpu.popStackWord());
@@ -1106,7 +1204,8 @@ int RETI_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0]; // 16 cycles
 }
 
-int RST_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int RST_impl(Core& cpu, const OpcodeInfo& info) {
     // RST n : Call subroutine at address 0x0000 + n.
     // n is stored in info.extraData (0x00, 0x08, 0x10, ..., 0x38)
     // Flags: - - - -
@@ -1118,7 +1217,8 @@ int RST_impl(CPU& cpu, const OpcodeInfo& info) {
 
 
 // --- Miscellaneous Instructions ---
-int DAA_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int DAA_impl(Core& cpu, const OpcodeInfo& info) {
     // DAA: Decimal Adjust Accumulator.
     // Flags: Z N H C
     //        Z - 0 C
@@ -1165,7 +1265,8 @@ int DAA_impl(CPU& cpu, const OpcodeInfo& info) {
 }
 
 
-int CPL_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CPL_impl(Core& cpu, const OpcodeInfo& info) {
     // CPL: Complement Accumulator (A = ~A).
     // Flags: Z N H C
     //        - 1 1 -
@@ -1176,7 +1277,8 @@ int CPL_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int SCF_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int SCF_impl(Core& cpu, const OpcodeInfo& info) {
     // SCF: Set Carry Flag.
     // Flags: Z N H C
     //        - 0 0 1
@@ -1187,7 +1289,8 @@ int SCF_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
-int CCF_impl(CPU& cpu, const OpcodeInfo& info) {
+template <typename Core>
+int CCF_impl(Core& cpu, const OpcodeInfo& info) {
     // CCF: Complement Carry Flag.
     // Flags: Z N H C
     //        - 0 0 C
@@ -1198,4 +1301,115 @@ int CCF_impl(CPU& cpu, const OpcodeInfo& info) {
     return info.cycles[0];
 }
 
+// --- Explicit instantiations for both CPU cores ---
+#define GB_INSTANTIATE_IMPL(name) \
+    template int name##_impl(FastCPU& cpu, const OpcodeInfo& info); \
+    template int name##_impl(AccurateCPU& cpu, const OpcodeInfo& info);
+
+GB_INSTANTIATE_IMPL(NOP)
+GB_INSTANTIATE_IMPL(HALT)
+GB_INSTANTIATE_IMPL(STOP)
+GB_INSTANTIATE_IMPL(DI)
+GB_INSTANTIATE_IMPL(EI)
+GB_INSTANTIATE_IMPL(LD_reg_reg)
+GB_INSTANTIATE_IMPL(LD_reg_n8)
+GB_INSTANTIATE_IMPL(LD_reg_memHL)
+GB_INSTANTIATE_IMPL(LD_memHL_reg)
+GB_INSTANTIATE_IMPL(LD_memHL_n8)
+GB_INSTANTIATE_IMPL(LD_A_memBC)
+GB_INSTANTIATE_IMPL(LD_A_memDE)
+GB_INSTANTIATE_IMPL(LD_A_memA16)
+GB_INSTANTIATE_IMPL(LD_memBC_A)
+GB_INSTANTIATE_IMPL(LD_memDE_A)
+GB_INSTANTIATE_IMPL(LD_memA16_A)
+GB_INSTANTIATE_IMPL(LDH_memA8_A)
+GB_INSTANTIATE_IMPL(LDH_A_memA8)
+GB_INSTANTIATE_IMPL(LDH_memC_A)
+GB_INSTANTIATE_IMPL(LDH_A_memC)
+GB_INSTANTIATE_IMPL(LD_A_memHLI)
+GB_INSTANTIATE_IMPL(LD_A_memHLD)
+GB_INSTANTIATE_IMPL(LD_memHLI_A)
+GB_INSTANTIATE_IMPL(LD_memHLD_A)
+GB_INSTANTIATE_IMPL(LD_rr_n16)
+GB_INSTANTIATE_IMPL(LD_SP_HL)
+GB_INSTANTIATE_IMPL(LD_memA16_SP)
+GB_INSTANTIATE_IMPL(LD_HL_SP_e8)
+GB_INSTANTIATE_IMPL(PUSH_rr)
+GB_INSTANTIATE_IMPL(POP_rr)
+GB_INSTANTIATE_IMPL(ADD_A_reg)
+GB_INSTANTIATE_IMPL(ADD_A_n8)
+GB_INSTANTIATE_IMPL(ADD_A_memHL)
+GB_INSTANTIATE_IMPL(ADC_A_reg)
+GB_INSTANTIATE_IMPL(ADC_A_n8)
+GB_INSTANTIATE_IMPL(ADC_A_memHL)
+GB_INSTANTIATE_IMPL(SUB_A_reg)
+GB_INSTANTIATE_IMPL(SUB_A_n8)
+GB_INSTANTIATE_IMPL(SUB_A_memHL)
+GB_INSTANTIATE_IMPL(SBC_A_reg)
+GB_INSTANTIATE_IMPL(SBC_A_n8)
+GB_INSTANTIATE_IMPL(SBC_A_memHL)
+GB_INSTANTIATE_IMPL(AND_A_reg)
+GB_INSTANTIATE_IMPL(AND_A_n8)
+GB_INSTANTIATE_IMPL(AND_A_memHL)
+GB_INSTANTIATE_IMPL(XOR_A_reg)
+GB_INSTANTIATE_IMPL(XOR_A_n8)
+GB_INSTANTIATE_IMPL(XOR_A_memHL)
+GB_INSTANTIATE_IMPL(OR_A_reg)
+GB_INSTANTIATE_IMPL(OR_A_n8)
+GB_INSTANTIATE_IMPL(OR_A_memHL)
+GB_INSTANTIATE_IMPL(CP_A_reg)
+GB_INSTANTIATE_IMPL(CP_A_n8)
+GB_INSTANTIATE_IMPL(CP_A_memHL)
+GB_INSTANTIATE_IMPL(INC_reg)
+GB_INSTANTIATE_IMPL(INC_memHL)
+GB_INSTANTIATE_IMPL(DEC_reg)
+GB_INSTANTIATE_IMPL(DEC_memHL)
+GB_INSTANTIATE_IMPL(ADD_HL_rr)
+GB_INSTANTIATE_IMPL(ADD_SP_e8)
+GB_INSTANTIATE_IMPL(INC_rr)
+GB_INSTANTIATE_IMPL(DEC_rr)
+GB_INSTANTIATE_IMPL(RLCA)
+GB_INSTANTIATE_IMPL(RLA)
+GB_INSTANTIATE_IMPL(RRCA)
+GB_INSTANTIATE_IMPL(RRA)
+GB_INSTANTIATE_IMPL(RLC_reg)
+GB_INSTANTIATE_IMPL(RLC_memHL)
+GB_INSTANTIATE_IMPL(RRC_reg)
+GB_INSTANTIATE_IMPL(RRC_memHL)
+GB_INSTANTIATE_IMPL(RL_reg)
+GB_INSTANTIATE_IMPL(RL_memHL)
+GB_INSTANTIATE_IMPL(RR_reg)
+GB_INSTANTIATE_IMPL(RR_memHL)
+GB_INSTANTIATE_IMPL(SLA_reg)
+GB_INSTANTIATE_IMPL(SLA_memHL)
+GB_INSTANTIATE_IMPL(SRA_reg)
+GB_INSTANTIATE_IMPL(SRA_memHL)
+GB_INSTANTIATE_IMPL(SWAP_reg)
+GB_INSTANTIATE_IMPL(SWAP_memHL)
+GB_INSTANTIATE_IMPL(SRL_reg)
+GB_INSTANTIATE_IMPL(SRL_memHL)
+GB_INSTANTIATE_IMPL(BIT_b_reg)
+GB_INSTANTIATE_IMPL(BIT_b_memHL)
+GB_INSTANTIATE_IMPL(RES_b_reg)
+GB_INSTANTIATE_IMPL(RES_b_memHL)
+GB_INSTANTIATE_IMPL(SET_b_reg)
+GB_INSTANTIATE_IMPL(SET_b_memHL)
+GB_INSTANTIATE_IMPL(JP_n16)
+GB_INSTANTIATE_IMPL(JP_cc_n16)
+GB_INSTANTIATE_IMPL(JP_HL)
+GB_INSTANTIATE_IMPL(JR_e8)
+GB_INSTANTIATE_IMPL(JR_cc_e8)
+GB_INSTANTIATE_IMPL(CALL_n16)
+GB_INSTANTIATE_IMPL(CALL_cc_n16)
+GB_INSTANTIATE_IMPL(RET)
+GB_INSTANTIATE_IMPL(RET_cc)
+GB_INSTANTIATE_IMPL(RETI)
+GB_INSTANTIATE_IMPL(RST)
+GB_INSTANTIATE_IMPL(DAA)
+GB_INSTANTIATE_IMPL(CPL)
+GB_INSTANTIATE_IMPL(SCF)
+GB_INSTANTIATE_IMPL(CCF)
+
+#undef GB_INSTANTIATE_IMPL
+
 } // namespace GB
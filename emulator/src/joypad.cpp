@@ -1,6 +1,68 @@
 #include "joypad.h"
+#include <chrono>
+
+namespace {
+constexpr uint64_t STAMP_MASK = (1ULL << 56) - 1;
+}
+
+Joypad::Joypad()
+    : m_Published(BYTE_MASK)    // All buttons unpressed (1), not timed
+    , m_SeenPressed(0)
+    , m_SampledStamp(0)
+    , m_Samples(0)
+    , m_TotalNs(0)
+    , m_MaxNs(0)
+    , m_LastNs(0)
+{
+}
+
+uint64_t Joypad::nowNs() {
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    now &= STAMP_MASK;
+    return now != 0 ? now : 1;
+}
+
+// Both threads may write (UI publishes, a replay applies), hence the CAS
+void Joypad::update(int key, bool pressed, uint64_t stampNs) {
+    uint64_t word = m_Published.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        BYTE state = static_cast<BYTE>(word);
+        state = pressed ? (state & ~(1 << key)) : (state | (1 << key));
+        next = (stampNs << 8) | state;
+    } while (!m_Published.compare_exchange_weak(word, next, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Joypad::publish(int key, bool pressed) {
+    update(key, pressed, nowNs());
+}
+
+void Joypad::KeyPressed(int key) {
+    update(key, true, 0);
+}
+
+void Joypad::KeyReleased(int key) {
+    update(key, false, 0);
+}
 
 BYTE Joypad::GetState(BYTE joypadRequest) {
+    uint64_t word = m_Published.load(std::memory_order_acquire);
+    BYTE joypadState = static_cast<BYTE>(word);
+
+    // First read since a timed change: that is when the guest can react to it
+    uint64_t stamp = word >> 8;
+    if (stamp != 0 && stamp != m_SampledStamp) {
+        m_SampledStamp = stamp;
+        uint64_t latency = (nowNs() - stamp) & STAMP_MASK;
+        m_Samples.fetch_add(1, std::memory_order_relaxed);
+        m_TotalNs.fetch_add(latency, std::memory_order_relaxed);
+        m_LastNs.store(latency, std::memory_order_relaxed);
+        if (latency > m_MaxNs.load(std::memory_order_relaxed)) {
+            m_MaxNs.store(latency, std::memory_order_relaxed);
+        }
+    }
+
     BYTE joypadOutput = 0x0F; // Initialize with all buttons unpressed (1)
 
     if (!(joypadRequest & JOYPAD_SELECT_DIRECTIONS)) {
@@ -10,23 +72,25 @@ BYTE Joypad::GetState(BYTE joypadRequest) {
         if (!(joypadState & (1 << JOYPAD_UP))) joypadOutput &= ~(1 << JOYPAD_UP);
         if (!(joypadState & (1 << JOYPAD_DOWN))) joypadOutput &= ~(1 << JOYPAD_DOWN);
     } else if (!(joypadRequest & JOYPAD_SELECT_BUTTONS)) {
-        // Button keys are selected
-        if (!(joypadState & (1 << JOYPAD_A))) joypadOutput &= ~(1 << JOYPAD_A);
-        if (!(joypadState & (1 << JOYPAD_B))) joypadOutput &= ~(1 << JOYPAD_B);
-        if (!(joypadState & (1 << JOYPAD_SELECT))) joypadOutput &= ~(1 << JOYPAD_SELECT);
-        if (!(joypadState & (1 << JOYPAD_START))) joypadOutput &= ~(1 << JOYPAD_START);
+        // Button keys are selected (A, B, Select, Start sit in bits 4-7 of the state)
+        joypadOutput &= (joypadState >> 4) | 0xF0;
     }
 
     return joypadOutput;
 }
 
-void Joypad::KeyPressed(int key) {
-    //bool previouslyUnset = (joypadState & (1 << key)) != 0;
+BYTE Joypad::takeNewPresses() {
+    BYTE pressed = static_cast<BYTE>(~m_Published.load(std::memory_order_acquire));
+    BYTE newPresses = pressed & ~m_SeenPressed;
+    m_SeenPressed = pressed;
+    return newPresses;
+}
 
-    // Set the bit in joypadState to 0 (pressed)
-    joypadState &= ~(1 << key);
+InputLatencyStats Joypad::latencyStats() const {
+    InputLatencyStats stats;
+    stats.samples = m_Samples.load(std::memory_order_relaxed);
+    stats.meanUs = stats.samples ? m_TotalNs.load(std::memory_order_relaxed) / 1000.0 / stats.samples : 0.0;
+    stats.maxUs = m_MaxNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.lastUs = m_LastNs.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
 }
-void Joypad::KeyReleased(int key) {
-    // Set the bit in joypadState to 1 (released)
-    joypadState |= (1 << key);
-}
\ No newline at end of file
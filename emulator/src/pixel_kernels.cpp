@@ -0,0 +1,326 @@
+#include <pixel_kernels.h>
+#include <logger.h>
+#include <chrono>
+#include <cstring>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void decodeRowsScalar(const BYTE* planes, int rows, BYTE* indices) {
+    for (int y = 0; y < rows; y++) {
+        BYTE low = planes[y * 2];
+        BYTE high = planes[y * 2 + 1];
+        for (int x = 0; x < TILE_WIDTH; x++) {
+            int bit = 7 - x;
+            indices[y * TILE_WIDTH + x] = static_cast<BYTE>((((high >> bit) & 1) << 1) | ((low >> bit) & 1));
+        }
+    }
+}
+
+void mapIndicesScalar(const BYTE* indices, int count, const BYTE* table, BYTE* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = table[indices[i]];
+    }
+}
+
+void expandIndicesScalar(const BYTE* indices, int count, const Uint32* palette, Uint32* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = palette[indices[i]];
+    }
+}
+
+void expandIndices16Scalar(const BYTE* indices, int count, const Uint16* palette, Uint16* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = palette[indices[i]];
+    }
+}
+
+#ifdef PIXEL_KERNELS_X86
+// Two rows (16 pixels) per step: each plane byte is broadcast over 8 lanes,
+// and comparing it against one bit per lane yields that pixel's plane bit
+__attribute__((target("sse2")))
+void decodeRowsSSE2(const BYTE* planes, int rows, BYTE* indices) {
+    const __m128i bits = _mm_setr_epi8(char(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                       char(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    int y = 0;
+    for (; y + 2 <= rows; y += 2) {
+        const BYTE* row = planes + y * 2;
+        __m128i low = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(row[0])), _mm_set1_epi8(static_cast<char>(row[2])));
+        __m128i high = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(row[1])), _mm_set1_epi8(static_cast<char>(row[3])));
+        __m128i lowBits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(low, bits), bits), one);
+        __m128i highBits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(high, bits), bits), two);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + y * TILE_WIDTH), _mm_or_si128(lowBits, highBits));
+    }
+    if (y < rows) {
+        decodeRowsScalar(planes + y * 2, rows - y, indices + y * TILE_WIDTH);
+    }
+}
+
+// No byte shuffle before SSSE3: each of the four indices selects its table
+// byte through a compare mask, 16 pixels per step
+__attribute__((target("sse2")))
+void mapIndicesSSE2(const BYTE* indices, int count, const BYTE* table, BYTE* out) {
+    __m128i values[4];
+    __m128i keys[4];
+    for (int k = 0; k < 4; k++) {
+        values[k] = _mm_set1_epi8(static_cast<char>(table[k]));
+        keys[k] = _mm_set1_epi8(static_cast<char>(k));
+    }
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+        __m128i result = _mm_and_si128(_mm_cmpeq_epi8(lanes, keys[0]), values[0]);
+        for (int k = 1; k < 4; k++) {
+            result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi8(lanes, keys[k]), values[k]));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+    mapIndicesScalar(indices + i, count - i, table, out + i);
+}
+
+// SSE2 has no variable shuffle; a 16-entry table of pixel pairs turns two
+// indices into 64 bits, and two pairs make one 128-bit store
+__attribute__((target("sse2")))
+void expandIndicesSSE2(const BYTE* indices, int count, const Uint32* palette, Uint32* out) {
+    uint64_t pairs[16];
+    for (int right = 0; right < 4; right++) {
+        for (int left = 0; left < 4; left++) {
+            pairs[left | (right << 2)] = palette[left] | (static_cast<uint64_t>(palette[right]) << 32);
+        }
+    }
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint64_t first = pairs[indices[i] | (indices[i + 1] << 2)];
+        uint64_t second = pairs[indices[i + 2] | (indices[i + 3] << 2)];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_set_epi64x(static_cast<long long>(second), static_cast<long long>(first)));
+    }
+    expandIndicesScalar(indices + i, count - i, palette, out + i);
+}
+
+// As above with 16-bit pixels: pairs are 32 bits, four make a store
+__attribute__((target("sse2")))
+void expandIndices16SSE2(const BYTE* indices, int count, const Uint16* palette, Uint16* out) {
+    uint32_t pairs[16];
+    for (int right = 0; right < 4; right++) {
+        for (int left = 0; left < 4; left++) {
+            pairs[left | (right << 2)] = palette[left] | (static_cast<uint32_t>(palette[right]) << 16);
+        }
+    }
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_setr_epi32(static_cast<int>(pairs[indices[i] | (indices[i + 1] << 2)]),
+                                        static_cast<int>(pairs[indices[i + 2] | (indices[i + 3] << 2)]),
+                                        static_cast<int>(pairs[indices[i + 4] | (indices[i + 5] << 2)]),
+                                        static_cast<int>(pairs[indices[i + 6] | (indices[i + 7] << 2)])));
+    }
+    expandIndices16Scalar(indices + i, count - i, palette, out + i);
+}
+
+// pdep deposits the 8 plane bits one per byte (bit 0 in byte 0); the byte
+// swap puts the leftmost pixel (bit 7) first
+__attribute__((target("avx2,bmi2")))
+void decodeRowsAVX2(const BYTE* planes, int rows, BYTE* indices) {
+    const unsigned long long spread = 0x0101010101010101ULL;
+    for (int y = 0; y < rows; y++) {
+        unsigned long long low = __builtin_bswap64(_pdep_u64(planes[y * 2], spread));
+        unsigned long long high = __builtin_bswap64(_pdep_u64(planes[y * 2 + 1], spread));
+        unsigned long long row = low | (high << 1);
+        memcpy(indices + y * TILE_WIDTH, &row, sizeof(row));  // x86 is little-endian: byte 0 is pixel 0
+    }
+}
+
+// The table sits in the low bytes of each 128-bit lane and the indices pick
+// from it directly, 32 pixels per step
+__attribute__((target("avx2")))
+void mapIndicesAVX2(const BYTE* indices, int count, const BYTE* table, BYTE* out) {
+    uint32_t packed;
+    memcpy(&packed, table, sizeof(packed));
+    const __m256i lut = _mm256_set1_epi32(static_cast<int>(packed));
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(lut, lanes));
+    }
+    mapIndicesScalar(indices + i, count - i, table, out + i);
+}
+
+// Eight pixels per step: widen the indices to 32 bits and use them to
+// permute a register holding the palette
+__attribute__((target("avx2")))
+void expandIndicesAVX2(const BYTE* indices, int count, const Uint32* palette, Uint32* out) {
+    const __m256i lut = _mm256_setr_epi32(static_cast<int>(palette[0]), static_cast<int>(palette[1]),
+                                          static_cast<int>(palette[2]), static_cast<int>(palette[3]),
+                                          static_cast<int>(palette[0]), static_cast<int>(palette[1]),
+                                          static_cast<int>(palette[2]), static_cast<int>(palette[3]));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permutevar8x32_epi32(lut, lanes));
+    }
+    expandIndicesScalar(indices + i, count - i, palette, out + i);
+}
+
+// Two 8-pixel permutes narrowed to 16 bits; the pack works per 128-bit lane,
+// so a cross-lane permute restores pixel order
+__attribute__((target("avx2")))
+void expandIndices16AVX2(const BYTE* indices, int count, const Uint16* palette, Uint16* out) {
+    const __m256i lut = _mm256_setr_epi32(palette[0], palette[1], palette[2], palette[3],
+                                          palette[0], palette[1], palette[2], palette[3]);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i first = _mm256_permutevar8x32_epi32(lut,
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i))));
+        __m256i second = _mm256_permutevar8x32_epi32(lut,
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i + 8))));
+        __m256i pixels = _mm256_permute4x64_epi64(_mm256_packus_epi32(first, second), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pixels);
+    }
+    expandIndices16Scalar(indices + i, count - i, palette, out + i);
+}
+#endif
+
+const PixelKernels SCALAR_KERNELS = { "scalar", decodeRowsScalar, mapIndicesScalar, expandIndicesScalar, expandIndices16Scalar };
+#ifdef PIXEL_KERNELS_X86
+const PixelKernels SSE2_KERNELS = { "sse2", decodeRowsSSE2, mapIndicesSSE2, expandIndicesSSE2, expandIndices16SSE2 };
+const PixelKernels AVX2_KERNELS = { "avx2", decodeRowsAVX2, mapIndicesAVX2, expandIndicesAVX2, expandIndices16AVX2 };
+#endif
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+std::vector<const PixelKernels*> availablePixelKernels() {
+    std::vector<const PixelKernels*> kernels = { &SCALAR_KERNELS };
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.push_back(&SSE2_KERNELS);
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")) {
+        kernels.push_back(&AVX2_KERNELS);
+    }
+#endif
+    return kernels;
+}
+
+const PixelKernels& pixelKernels() {
+    static const PixelKernels* selected = []() {
+        const PixelKernels* best = availablePixelKernels().back();
+        LOG_INFO(std::string("Pixel kernels: ") + best->name);
+        return best;
+    }();
+    return *selected;
+}
+
+std::vector<PixelKernelTiming> benchmarkPixelKernels(int lines) {
+    constexpr int TILE_ROWS_PER_LINE = SCREEN_PIXELS_WIDTH / TILE_WIDTH;
+    BYTE planes[TILE_ROWS_PER_LINE * 2];
+    uint32_t seed = 0x12345678;
+    for (BYTE& plane : planes) {
+        seed = seed * 1664525u + 1013904223u;
+        plane = static_cast<BYTE>(seed >> 24);
+    }
+    const BYTE table[4] = { 0, 3, 1, 2 };
+    const Uint32 palette[4] = { 0xFFFFFFFF, 0xAAAAAAFF, 0x555555FF, 0x000000FF };
+
+    std::vector<PixelKernelTiming> results;
+    volatile Uint32 sink = 0;
+    for (const PixelKernels* kernels : availablePixelKernels()) {
+        BYTE indices[SCREEN_PIXELS_WIDTH];
+        BYTE shades[SCREEN_PIXELS_WIDTH];
+        Uint32 pixels[SCREEN_PIXELS_WIDTH];
+
+        int64_t start = nowNs();
+        for (int line = 0; line < lines; line++) {
+            planes[line % (TILE_ROWS_PER_LINE * 2)] ^= 1;  // Keep the work from being hoisted
+            kernels->decodeRows(planes, TILE_ROWS_PER_LINE, indices);
+            sink = sink + indices[line % SCREEN_PIXELS_WIDTH];
+        }
+        int64_t decodeNs = nowNs() - start;
+
+        start = nowNs();
+        for (int line = 0; line < lines; line++) {
+            indices[line % SCREEN_PIXELS_WIDTH] ^= 1;
+            kernels->mapIndices(indices, SCREEN_PIXELS_WIDTH, table, shades);
+            sink = sink + shades[line % SCREEN_PIXELS_WIDTH];
+        }
+        int64_t mapNs = nowNs() - start;
+
+        start = nowNs();
+        for (int line = 0; line < lines; line++) {
+            indices[line % SCREEN_PIXELS_WIDTH] ^= 1;
+            kernels->expandIndices(indices, SCREEN_PIXELS_WIDTH, palette, pixels);
+            sink = sink + pixels[line % SCREEN_PIXELS_WIDTH];
+        }
+        int64_t expandNs = nowNs() - start;
+
+        // Same input through both versions
+        const Uint16 palette16[4] = { 0xFFFF, 0xAD55, 0x52AA, 0x0000 };
+        Uint16 pixels16[SCREEN_PIXELS_WIDTH];
+        kernels->decodeRows(planes, TILE_ROWS_PER_LINE, indices);
+        kernels->mapIndices(indices, SCREEN_PIXELS_WIDTH, table, shades);
+        kernels->expandIndices(indices, SCREEN_PIXELS_WIDTH, palette, pixels);
+        kernels->expandIndices16(indices, SCREEN_PIXELS_WIDTH, palette16, pixels16);
+        BYTE scalarIndices[SCREEN_PIXELS_WIDTH];
+        BYTE scalarShades[SCREEN_PIXELS_WIDTH];
+        Uint32 scalarPixels[SCREEN_PIXELS_WIDTH];
+        Uint16 scalarPixels16[SCREEN_PIXELS_WIDTH];
+        SCALAR_KERNELS.decodeRows(planes, TILE_ROWS_PER_LINE, scalarIndices);
+        SCALAR_KERNELS.mapIndices(scalarIndices, SCREEN_PIXELS_WIDTH, table, scalarShades);
+        SCALAR_KERNELS.expandIndices(scalarIndices, SCREEN_PIXELS_WIDTH, palette, scalarPixels);
+        SCALAR_KERNELS.expandIndices16(scalarIndices, SCREEN_PIXELS_WIDTH, palette16, scalarPixels16);
+
+        PixelKernelTiming timing;
+        timing.name = kernels->name;
+        timing.decodeNsPerLine = static_cast<double>(decodeNs) / lines;
+        timing.mapNsPerLine = static_cast<double>(mapNs) / lines;
+        timing.expandNsPerLine = static_cast<double>(expandNs) / lines;
+        timing.matchesScalar = memcmp(indices, scalarIndices, sizeof(indices)) == 0 &&
+                               memcmp(shades, scalarShades, sizeof(shades)) == 0 &&
+                               memcmp(pixels, scalarPixels, sizeof(pixels)) == 0 &&
+                               memcmp(pixels16, scalarPixels16, sizeof(pixels16)) == 0;
+        results.push_back(timing);
+        LOG_INFO(std::string(timing.name) + ": decode " + std::to_string(timing.decodeNsPerLine) +
+                 " ns/line, BGP " + std::to_string(timing.mapNsPerLine) +
+                 " ns/line, palette " + std::to_string(timing.expandNsPerLine) + " ns/line" +
+                 (timing.matchesScalar ? "" : " - OUTPUT DIFFERS FROM SCALAR"));
+    }
+    return results;
+}
+
+void convertShades(const BYTE* shades, int width, int height, const Uint32* palette,
+                   FramePixelFormat format, void* out, int pitch) {
+    const PixelKernels& kernels = pixelKernels();
+    BYTE* row = static_cast<BYTE*>(out);
+    if (format == FramePixelFormat::RGB565) {
+        Uint16 palette16[4];
+        for (int shade = 0; shade < 4; shade++) {
+            Uint32 color = palette[shade];
+            palette16[shade] = static_cast<Uint16>(((color >> 16) & 0xF800) | ((color >> 13) & 0x07E0) | ((color >> 11) & 0x001F));
+        }
+        for (int y = 0; y < height; y++, row += pitch) {
+            kernels.expandIndices16(shades + static_cast<size_t>(y) * width, width, palette16, reinterpret_cast<Uint16*>(row));
+        }
+        return;
+    }
+
+    Uint32 converted[4];
+    for (int shade = 0; shade < 4; shade++) {
+        Uint32 color = palette[shade];
+        converted[shade] = format == FramePixelFormat::RGBA8888
+            ? color
+            : ((color & 0x0000FF00) << 16) | (color & 0x00FF00FF) | ((color >> 16) & 0x0000FF00);  // Swap R and B
+    }
+    for (int y = 0; y < height; y++, row += pitch) {
+        kernels.expandIndices(shades + static_cast<size_t>(y) * width, width, converted, reinterpret_cast<Uint32*>(row));
+    }
+}
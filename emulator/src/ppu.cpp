@@ -2,6 +2,8 @@
 #include <cstring> // For memset
 #include <sstream> // For logging
 #include <iomanip> // For std::hex
+#include <algorithm>
+#include <chrono>
 
 // Define register addresses if not in common.h or ppu.h
 #define LCD_CONTROL 0xFF40
@@ -31,440 +33,517 @@
 // Define LCDC register bits
 #define LCD_ENABLE_BIT 0x80 // Bit 7: LCD Display Enable
 
+namespace {
+// Multiply-rotate hash, eight bytes at a time; only has to tell frames apart
+uint64_t hashBytes(const BYTE* bytes, size_t count) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ count;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash = (hash << 31) | (hash >> 33);
+    }
+    for (; i < count; i++) {
+        hash = (hash ^ bytes[i]) * 0xFF51AFD7ED558CCDULL;
+    }
+    return hash ^ (hash >> 29);
+}
+}
 
 PPU::PPU(std::shared_ptr<MemoryController> memory)
     : memoryController(memory),
-      scanlineCounter(SCANLINE_CYCLES), // Start with full cycles for a scanline
-      currentMode(MODE_OAM), // PPU starts in Mode 2 (OAM Scan) after power on
-      screenBuffer(SCREEN_PIXELS_WIDTH * SCREEN_PIXELS_HEIGHT, 0xFFFFFFFF), // Initialize buffer
-      frameRendered(false),
-      frameCount(0),
+      m_State(memory->state()),
+      m_VRAM(memory->getVRAM()),
+      m_OAM(memory->getOAM()),
+      m_LCDRegisters(memory->getLCDRegisters()),
+      m_Scheduler(memory->scheduler()),
+      m_Timing(memory->state().ppuTiming),
+      currentMode(memory->state().ppu.mode),
+      m_TileCache(m_VRAM),
+      m_SpriteLines(m_OAM),
+      m_Kernels(pixelKernels()),
+      m_Scheme(COLOR_SCHEME_GREYSCALE),
+      m_Frames(PPUFrame{std::vector<BYTE>(SCREEN_PIXELS_WIDTH * SCREEN_PIXELS_HEIGHT, 0),
+                        {COLOR_SCHEME_GREYSCALE.shades[0], COLOR_SCHEME_GREYSCALE.shades[1],
+                         COLOR_SCHEME_GREYSCALE.shades[2], COLOR_SCHEME_GREYSCALE.shades[3]}, 0}), // Initialize buffers
+      m_Context{m_VRAM, m_LCDRegisters, m_OAM, m_TileCache, m_SpriteLines, m_Kernels,
+                m_BGShades, m_OBJShades, m_Frames.back().shades.data()},
+      m_Engine(createPPUEngine(PPUEngineKind::SCANLINE, m_Context)),
       prevLCDControl(0), // Initialize previous states
-      prevBGP(0)
+      prevBGP(0),
+      frameRendered(false),
+      frameCount(0)
 {
+    m_Scheduler.setHandler(SchedulerEvent::PPU_INTERRUPT, [this](uint64_t deadline) { onInterruptPoint(deadline); });
+    setColorScheme(m_Scheme);
     LOG_INFO("PPU initialized");
-    // Initial PPU state often involves setting LY=0 and starting in Mode 2
-    memoryController->write(LY_REGISTER, 0);
-    setLCDStatus(MODE_OAM); // Explicitly set initial mode and check interrupts
+    // PPU starts at LY=0 in Mode 2 (OAM Scan) after power on
+    startFrame();
+}
+
+PPU::~PPU() {
+    m_Scheduler.cancel(SchedulerEvent::PPU_INTERRUPT);
+    m_Scheduler.setHandler(SchedulerEvent::PPU_INTERRUPT, nullptr);
 }
 
 void PPU::reset() {
-    scanlineCounter = SCANLINE_CYCLES; // Reset counter
-    currentMode = MODE_OAM; // Reset to initial mode
-    screenBuffer.assign(SCREEN_PIXELS_WIDTH * SCREEN_PIXELS_HEIGHT, 0xFFFFFFFF); // Reset to white
+    syncWorker();
+    m_TileCache.invalidateAll();
+    m_SpriteLines.invalidate();
+    setColorScheme(m_Scheme);
+    std::vector<BYTE>& shades = m_Frames.back().shades;
+    std::fill(shades.begin(), shades.end(), 0); // Reset to the lightest shade
+    markAllRowsChanged();
+    m_Context.frame = publishFrame(m_PresentedFrames.load(std::memory_order_relaxed));
+    if (m_Worker) {
+        m_Worker->reload(m_Context.frame);
+    }
     frameRendered = false;
     frameCount = 0;
     prevLCDControl = 0;
     prevBGP = 0;
-    memoryController->write(LY_REGISTER, 0); // Reset scanline register
-    // Reset STAT register (except maybe LYC coincidence bit if LY=LYC=0 initially)
-    BYTE initialStat = memoryController->read(STAT_REGISTER) & 0x80; // Keep upper bit if needed
-    initialStat |= MODE_OAM; // Set initial mode
-    if(memoryController->read(LYC_REGISTER) == 0) {
-        initialStat |= STAT_LYC_EQ_LY; // Set coincidence if LYC=0
-    }
-    memoryController->write(STAT_REGISTER, initialStat);
+    startFrame();
 
     LOG_INFO("PPU reset to initial state");
 }
 
-void PPU::update(int cycles) {
-    // monitorRegisterChanges(); // Can be noisy, enable if needed
+// LY=0, mode 2, with the frame starting now. With the LCD off the PPU idles
+// and nothing is scheduled.
+void PPU::startFrame() {
+    m_Timing.frameStart = m_Scheduler.now();
+    m_Timing.lastCycle = m_Timing.frameStart;
+    m_ModeValidUntil = 0;
+    m_State.ioRegister(LY_REGISTER) = 0;
+    m_State.ppu.transferExtra = 0;
+    m_SkipFrame = m_SkipRequested;
+    m_LineOpen = false;
+    if (isLCDEnabled()) {
+        setMode(MODE_OAM);
+        scheduleNextInterrupt();
+    } else {
+        // Pandocs: mode reads 0 and LY stays 0 while the LCD is off
+        setMode(MODE_HBLANK);
+        m_Scheduler.cancel(SchedulerEvent::PPU_INTERRUPT);
+    }
+}
 
-    if (!isLCDEnabled()) {
-        // If LCD was just disabled, reset state
-        if (currentMode != MODE_VBLANK || memoryController->read(LY_REGISTER) != 0) {
-             LOG_INFO("LCD Disabled - Resetting PPU state (LY=0, Mode=VBLANK)");
-             scanlineCounter = SCANLINE_CYCLES;
-             memoryController->write(LY_REGISTER, 0);
-             // Update STAT register: Mode bits should be 1 (VBLANK) when LCD is off? Check manuals.
-             // Pandocs suggests mode is 0 when LCD disabled, but LY is 0. Let's try mode 0.
-             setLCDStatus(MODE_HBLANK); // Set mode 0 (HBLANK) when LCD disabled? Or VBLANK? Test.
-        }
-        return; // Do nothing further if LCD is off
+void PPU::onLCDControlWrite(BYTE previous, BYTE value) {
+    bool wasEnabled = (previous & LCD_ENABLE_BIT) != 0;
+    bool enabled = (value & LCD_ENABLE_BIT) != 0;
+    if (wasEnabled == enabled) {
+        return;
+    }
+
+    if (enabled) {
+        LOG_INFO("LCD Enabled - Starting PPU at LY=0");
+    } else {
+        LOG_INFO("LCD Disabled - Resetting PPU state (LY=0, Mode=HBLANK)");
+    }
+    startFrame();
+}
+
+void PPU::onStateLoaded() {
+    syncWorker();
+    m_ModeValidUntil = 0;
+    m_TileCache.invalidateAll();
+    m_SpriteLines.invalidate();
+    m_LineOpen = false;
+    setColorScheme(m_Scheme);
+    if (m_Worker) {
+        m_Worker->reload(m_Context.frame);
     }
+}
 
-    scanlineCounter -= cycles;
+void PPU::setEngine(PPUEngineKind kind) {
+    if (kind == m_Engine->kind()) {
+        return;
+    }
+    syncWorker();
+    m_Engine = createPPUEngine(kind, m_Context);
+    m_LineOpen = false;
+    LOG_INFO(std::string("PPU engine: ") + ppuEngineName(kind));
+    updateWorker();
+}
 
-    // Determine current PPU mode based on scanline counter and LY register
-    BYTE currentLine = memoryController->read(LY_REGISTER);
+void PPU::setRenderThread(bool enabled, const ThreadPlacementConfig& placement) {
+    m_WorkerRequested = enabled;
+    m_WorkerPlacement = placement;
+    updateWorker();
+}
 
-    // VBLANK Period (Lines 144-153)
-    if (currentLine >= VISIBLE_SCANLINES) {
-        if (currentMode != MODE_VBLANK) {
-            setLCDStatus(MODE_VBLANK);
-            // VBlank interrupt is requested only ONCE when transitioning to line 144
-            // It's handled in updateScanline when LY becomes 144.
-        }
+// Starts or stops the worker to match the request and the engine. A line
+// being drawn inline is finished inline; the worker takes the next one.
+void PPU::updateWorker() {
+    bool wanted = m_WorkerRequested && m_Engine->kind() == PPUEngineKind::SCANLINE;
+    if (wanted == (m_Worker != nullptr)) {
+        return;
     }
-    // Visible Scanline Period (Lines 0-143)
-    else {
-        if (scanlineCounter <= 0) { // End of HBLANK (Mode 0) -> Start of next line or VBLANK
-            // Move to next scanline
-            scanlineCounter += SCANLINE_CYCLES; // Reset counter for the new line
-            updateScanline(); // Increments LY, handles VBlank transition
-            // The new mode (OAM Scan) will be set at the start of the next update cycle check
-            // or by updateScanline if it transitions to VBlank.
-            // Check LYC again after LY increment
-             checkLYCInterrupt();
-             setLCDStatus(MODE_OAM); // Start of new line is OAM scan
-
-        } else if (scanlineCounter <= MODE_0_CYCLES) { // HBLANK (Mode 0)
-             if (currentMode != MODE_HBLANK) {
-                 setLCDStatus(MODE_HBLANK);
-                 // Render scanline data to buffer during HBlank? Or during Mode 3?
-                 // Usually Mode 3, but some do it here. Let's assume Mode 3 for now.
-             }
-        } else if (scanlineCounter <= MODE_0_CYCLES + MODE_3_CYCLES) { // Drawing (Mode 3)
-             if (currentMode != MODE_TRANSFER) {
-                 setLCDStatus(MODE_TRANSFER);
-                 // Perform the actual drawing for the current scanline
-                 drawScanline();
-             }
-        } else { // OAM Scan (Mode 2)
-             if (currentMode != MODE_OAM) {
-                 setLCDStatus(MODE_OAM);
-             }
-        }
+    if (!wanted) {
+        syncWorker();
+        m_Worker.reset();
+        m_TileCache.invalidateAll();    // VRAM writes were only followed by the worker's cache
+        m_SpriteLines.invalidate();
+        LOG_INFO("PPU rendering inline");
+        return;
     }
+    m_Worker = std::make_unique<PPUWorker>(
+        m_VRAM, m_OAM, m_Kernels, m_WorkerPlacement, m_Context.frame,
+        [this](int line, const BYTE* shades, uint32_t frame) { trackLine(line, shades, frame); },
+        [this](uint32_t sequence) { return completeFrame(sequence); });
+    LOG_INFO("PPU rendering on a worker thread");
+}
 
-    // Check LYC=LY coincidence again (might have changed due to LY increment)
-    // This check is now done within setLCDStatus and after updateScanline
-    // checkLYCInterrupt(); // Moved
+void PPU::syncWorker() {
+    if (m_Worker) {
+        m_Worker->sync();
+        m_Context.frame = m_Frames.back().shades.data();
+    }
 }
 
-// Add to PPU.cpp - Initialize once
-Uint32 PPU::mapColorToSDL(int r, int g, int b, int a) {
-    // Assuming SDL_PIXELFORMAT_RGBA8888 based on texture creation
-    return (static_cast<Uint32>(r) << 24) | (static_cast<Uint32>(g) << 16) | (static_cast<Uint32>(b) << 8) | static_cast<Uint32>(a);
+// Frames carry the scheme they were published with, so this applies from the
+// next completed frame. Every row counts as changed so it is shown in full.
+void PPU::setColorScheme(const ColorScheme& scheme) {
+    syncWorker();  // The worker reads the scheme when it publishes
+    m_Scheme = scheme;
+    rebuildPalette(BGP_REGISTER);
+    rebuildPalette(OBP0_REGISTER);
+    rebuildPalette(OBP1_REGISTER);
+    markAllRowsChanged();
 }
 
-void PPU::debugFillTestPattern() {
-    // Create a test pattern to verify the rendering pipeline
-    for (int y = 0; y < SCREEN_PIXELS_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_PIXELS_WIDTH; x++) {
-            Uint32 color;
-            if ((x / 16 + y / 16) % 2 == 0)
-                color = mapColorToSDL(255, 0, 0, 255); // Red
-            else
-                color = mapColorToSDL(255, 255, 255, 255); // White
-
-            size_t index = static_cast<size_t>(y) * SCREEN_PIXELS_WIDTH + x;
-            if (index < screenBuffer.size()) {
-                screenBuffer[index] = color;
-            }
-        }
+void PPU::rebuildPalette(WORD address) {
+    BYTE palette = reg(address);
+    BYTE* shades = address == BGP_REGISTER ? m_BGShades : m_OBJShades[address - OBP0_REGISTER];
+    for (int colorNum = 0; colorNum < 4; colorNum++) {
+        shades[colorNum] = (palette >> (colorNum * 2)) & 0x03;
     }
-    LOG_INFO("Test pattern generated - checksum: " + std::to_string(calculateBufferChecksum()));
 }
 
-void PPU::setLCDStatus(BYTE mode) {
-    // Get current status
-    BYTE status = memoryController->read(STAT_REGISTER);
-    BYTE currentLine = memoryController->read(LY_REGISTER); // Get current line
+void PPU::onStatusWrite() {
+    setMode(currentMode);
+    if (isLCDEnabled()) {
+        scheduleNextInterrupt();
+    }
+}
 
-    // Update mode bits (lower 2 bits)
-    status = (status & 0xFC) | (mode & 0x03);
+void PPU::catchUp() {
+    catchUpTo(m_Scheduler.now());
+}
 
-    // Update LYC=LY flag (bit 2)
-    bool coincidence = (currentLine == memoryController->read(LYC_REGISTER));
-    if (coincidence) {
-        status |= STAT_LYC_EQ_LY;
-    } else {
-        status &= ~STAT_LYC_EQ_LY;
+// Walks every mode boundary between the last catch-up and `cycle`. Lines whose
+// transfer started in that span are drawn back to back with the registers as
+// they are now - anything that could change them (VRAM, OAM and LCD register
+// writes) catches the PPU up first, so the result matches stepping per mode.
+// Interrupts are not raised here; their points are scheduler events.
+void PPU::catchUpTo(uint64_t cycle) {
+    if (cycle <= m_Timing.lastCycle) {
+        return;
+    }
+    if (!isLCDEnabled()) {
+        m_Timing.lastCycle = cycle;
+        m_ModeValidUntil = UINT64_MAX;  // Mode 0 until LCDC is written, which restarts the frame
+        return;
     }
+    for (;;) {
+        LinePoint point = nextPoint(static_cast<uint32_t>(m_Timing.lastCycle - m_Timing.frameStart));
+        uint64_t at = m_Timing.frameStart + point.position;
+        if (at > cycle) {
+            m_ModeValidUntil = at;
+            break;
+        }
+        if (point.position == FRAME_CYCLES) {
+            m_Timing.frameStart = at;
+        }
+        m_Timing.lastCycle = at;
+        enterPoint(point.line, point.kind);
+    }
+    m_Timing.lastCycle = cycle;
 
-    // Write updated status back
-    memoryController->write(STAT_REGISTER, status);
+    // Part way through a line's pixel transfer
+    if (m_LineOpen) {
+        uint32_t dot = static_cast<uint32_t>(cycle - m_Timing.frameStart) % SCANLINE_CYCLES;
+        m_Engine->advance(static_cast<int>(dot) - MODE_2_CYCLES);
+    }
+}
 
-    // Check for STAT interrupt conditions ONLY if mode actually changed or coincidence happened
-    if (mode != currentMode || (coincidence && !(currentMode == MODE_VBLANK && currentLine == 0))) { // Avoid double interrupt on LY=LYC=0 at frame start
-        bool requestInterrupt = false;
-        // LYC=LY interrupt check
-        if (coincidence && (status & STAT_LYC_INT)) {
-            requestInterrupt = true;
-            LOG_DEBUG("STAT Interrupt check: LYC=LY (" + std::to_string(currentLine) + ") and STAT bit 6 enabled.");
+// Visible lines: OAM (80) -> Transfer (172 + the engine's extra cycles) ->
+// HBlank (the rest); lines 144-153 are one 456-cycle VBlank step each. Lines
+// whose transfer has not started yet are assumed as long as the last one.
+PPU::LinePoint PPU::nextPoint(uint32_t position) const {
+    int line = static_cast<int>(position / SCANLINE_CYCLES);
+    uint32_t dot = position % SCANLINE_CYCLES;
+    uint32_t lineStart = static_cast<uint32_t>(line) * SCANLINE_CYCLES;
+
+    if (line < VISIBLE_SCANLINES) {
+        if (dot < MODE_2_CYCLES) {
+            return { lineStart + MODE_2_CYCLES, line, LINE_TRANSFER };
         }
-        // Mode interrupt check
-        switch (mode) {
-            case MODE_HBLANK: // Mode 0
-                if (status & STAT_HBLANK_INT) {
-                    requestInterrupt = true;
-                    LOG_DEBUG("STAT Interrupt check: Mode 0 (HBLANK) and STAT bit 3 enabled.");
-                }
-                break;
-            case MODE_VBLANK: // Mode 1
-                if (status & STAT_VBLANK_INT) {
-                    requestInterrupt = true;
-                    LOG_DEBUG("STAT Interrupt check: Mode 1 (VBLANK) and STAT bit 4 enabled.");
+        uint32_t transferEnd = MODE_2_CYCLES + MODE_3_CYCLES + m_State.ppu.transferExtra;
+        if (dot < transferEnd) {
+            return { lineStart + transferEnd, line, LINE_HBLANK };
+        }
+    }
+    int next = line + 1;
+    return { lineStart + SCANLINE_CYCLES, next < TOTAL_SCANLINES ? next : 0, LINE_START };
+}
+
+void PPU::enterPoint(int line, PointKind kind) {
+    switch (kind) {
+        case LINE_START:
+            m_State.ioRegister(LY_REGISTER) = static_cast<BYTE>(line);
+            setMode(line < VISIBLE_SCANLINES ? MODE_OAM : MODE_VBLANK);
+            if (line == 0) {
+                m_SkipFrame = m_SkipRequested;
+            } else if (line == VISIBLE_SCANLINES) {
+                frameRendered = true; // Mark frame as ready for presentation
+                frameCount++;
+                if (!m_SkipFrame) {
+                    uint32_t sequence = m_PresentedFrames.fetch_add(1, std::memory_order_release) + 1;
+                    if (m_Worker) {
+                        m_Worker->publishFrame(sequence);
+                    } else {
+                        m_Context.frame = completeFrame(sequence);
+                    }
                 }
-                // Note: VBlank interrupt (IF bit 0) is separate from STAT Mode 1 interrupt
-                break;
-            case MODE_OAM: // Mode 2
-                if (status & STAT_OAM_INT) {
-                    requestInterrupt = true;
-                    LOG_DEBUG("STAT Interrupt check: Mode 2 (OAM) and STAT bit 5 enabled.");
+            }
+            break;
+
+        case LINE_TRANSFER: {
+            // Timing is exact on skipped frames too, so the length is always asked for
+            int extra = m_Engine->transferCycles(line) - MODE_3_CYCLES;
+            setMode(MODE_TRANSFER);
+            if (extra != m_State.ppu.transferExtra) {
+                m_State.ppu.transferExtra = static_cast<BYTE>(extra);
+                // A pending HBlank interrupt was placed with the previous length
+                if (m_Scheduler.deadline(SchedulerEvent::PPU_INTERRUPT) > m_Timing.lastCycle) {
+                    scheduleNextInterrupt();
                 }
+            }
+            if (m_SkipFrame) {
                 break;
-            case MODE_TRANSFER: // Mode 3 - No interrupt for this mode
-                break;
-        }
-
-        if (requestInterrupt) {
-            memoryController->RequestInterrupt(LCD_INTERRUPT_BIT); // Use helper function
-            LOG_DEBUG("LCD STAT Interrupt Requested.");
+            }
+            if (m_Worker) {
+                m_Worker->drawLine(line, m_PresentedFrames.load(std::memory_order_relaxed) + 1,
+                                   m_LCDRegisters, m_BGShades, m_OBJShades);
+            } else {
+                m_Engine->beginLine(line);
+                m_LineOpen = true;
+            }
+            break;
         }
-    }
 
-    // Log mode change if it happened
-    if (mode != currentMode) {
-        LOG_DEBUG("PPU Mode changed: " + std::to_string(currentMode) +
-                  " -> " + std::to_string(mode) +
-                  " [Scanline: " + std::to_string(currentLine) + "]");
-        currentMode = mode;
+        case LINE_HBLANK:
+            if (m_LineOpen) {
+                m_Engine->endLine();
+                m_LineOpen = false;
+                trackLine(line, m_Context.line(line), m_PresentedFrames.load(std::memory_order_relaxed) + 1);
+            }
+            setMode(MODE_HBLANK);
+            break;
     }
 }
 
+BYTE PPU::interruptsAt(int line, PointKind kind) const {
+    BYTE status = reg(STAT_REGISTER);
+    bool statInterrupt = false;
+    BYTE bits = 0;
 
-// LYC check should be done separately or integrated into setLCDStatus
-void PPU::checkLYCInterrupt() {
-     BYTE currentLine = memoryController->read(LY_REGISTER);
-     BYTE compareValue = memoryController->read(LYC_REGISTER);
-     BYTE status = memoryController->read(STAT_REGISTER);
-     bool coincidence = (currentLine == compareValue);
+    switch (kind) {
+        case LINE_START:
+            if ((status & STAT_LYC_INT) && line == reg(LYC_REGISTER)) {
+                statInterrupt = true;
+            }
+            if (line < VISIBLE_SCANLINES && (status & STAT_OAM_INT)) {
+                statInterrupt = true;
+            }
+            if (line == VISIBLE_SCANLINES) {
+                bits |= VBLANK_INTERRUPT_BIT;
+                if (status & STAT_VBLANK_INT) {
+                    statInterrupt = true;
+                }
+            }
+            break;
 
-     // Update coincidence flag in STAT
-     if (coincidence) {
-         status |= STAT_LYC_EQ_LY;
-     } else {
-         status &= ~STAT_LYC_EQ_LY;
-     }
-     memoryController->write(STAT_REGISTER, status); // Write updated status
+        case LINE_HBLANK:
+            statInterrupt = (status & STAT_HBLANK_INT) != 0;
+            break;
 
-     // Request interrupt ONLY if coincidence is true AND LYC interrupt is enabled
-     if (coincidence && (status & STAT_LYC_INT)) {
-         memoryController->RequestInterrupt(LCD_INTERRUPT_BIT);
-         LOG_DEBUG("LYC=LY Interrupt Requested at LY=" + std::to_string(currentLine));
-     }
+        case LINE_TRANSFER: // Mode 3 - No interrupt for this mode
+            break;
+    }
+    if (statInterrupt) {
+        bits |= LCD_INTERRUPT_BIT;
+    }
+    return bits;
 }
 
-
-bool PPU::isLCDEnabled() const {
-    // Read LCDC directly for the most accurate state
-    return (memoryController->read(LCD_CONTROL) & LCD_ENABLE_BIT) != 0;
+// Schedules the first point after lastCycle that raises an interrupt under the
+// current STAT/LYC settings. VBlank always does, so this looks at most one frame ahead.
+void PPU::scheduleNextInterrupt() {
+    uint64_t frameStart = m_Timing.frameStart;
+    uint32_t position = static_cast<uint32_t>(m_Timing.lastCycle - frameStart);
+    for (;;) {
+        LinePoint point = nextPoint(position);
+        if (interruptsAt(point.line, point.kind) != 0) {
+            m_Scheduler.scheduleAt(SchedulerEvent::PPU_INTERRUPT, frameStart + point.position);
+            return;
+        }
+        if (point.position == FRAME_CYCLES) {
+            frameStart += FRAME_CYCLES;
+            position = 0;
+        } else {
+            position = point.position;
+        }
+    }
 }
 
-void PPU::updateScanline() {
-    BYTE currentLine = memoryController->read(LY_REGISTER);
-    currentLine++;
-    memoryController->write(LY_REGISTER, currentLine);
+void PPU::onInterruptPoint(uint64_t deadline) {
+    if (!isLCDEnabled()) {
+        return;
+    }
+    catchUpTo(deadline);
 
-    // Check LYC=LY coincidence immediately after incrementing LY
-    checkLYCInterrupt();
+    uint32_t position = static_cast<uint32_t>(deadline - m_Timing.frameStart);
+    int line = static_cast<int>(position / SCANLINE_CYCLES);
+    uint32_t dot = position % SCANLINE_CYCLES;
+    PointKind kind = dot == 0 ? LINE_START : (dot == MODE_2_CYCLES ? LINE_TRANSFER : LINE_HBLANK);
 
-    if (currentLine == VISIBLE_SCANLINES) {
-        // Transition to VBlank
-        setLCDStatus(MODE_VBLANK); // Set mode 1
-        requestVBlankInterrupt(); // Request VBlank interrupt (IF bit 0)
-        frameRendered = true; // Mark frame as ready for presentation
-        frameCount++;
-        // *** ADD THIS LOG ***
-        LOG_INFO("--- VBLANK STARTED (LY=" + std::to_string(currentLine) + ") ---");
-    } else if (currentLine >= TOTAL_SCANLINES) {
-        // Wrap around LY
-        memoryController->write(LY_REGISTER, 0);
-        // LYC check for LY=0
-        checkLYCInterrupt();
-        // Transition back to Mode 2 (OAM Scan) for the new frame
-        setLCDStatus(MODE_OAM);
-        LOG_DEBUG("--- New Frame Start (LY=0) ---");
+    BYTE bits = interruptsAt(line, kind);
+    if (bits & VBLANK_INTERRUPT_BIT) {
+        memoryController->RequestInterrupt(VBLANK_INTERRUPT_BIT);
+        LOG_DEBUG("--- VBLANK STARTED (LY=" + std::to_string(line) + ") ---");
     }
-    // No else needed, if line < 144, the mode transition happens in update() based on cycles
-}
-
-void PPU::requestVBlankInterrupt() {
-    memoryController->RequestInterrupt(VBLANK_INTERRUPT_BIT); // Use helper function
-    LOG_DEBUG("VBlank Interrupt Requested (IF bit 0 set)");
+    if (bits & LCD_INTERRUPT_BIT) {
+        memoryController->RequestInterrupt(LCD_INTERRUPT_BIT);
+        LOG_DEBUG("LCD STAT Interrupt Requested at LY=" + std::to_string(line));
+    }
+    scheduleNextInterrupt();
 }
 
-void PPU::drawScanline() {
-    BYTE control = memoryController->read(LCD_CONTROL);
-
-    // Fill scanline with white initially or based on BG color 0?
-    // Let's assume white for now if BG disabled.
-    // std::fill_n(screenBuffer.begin() + currentLine * SCREEN_PIXELS_WIDTH, SCREEN_PIXELS_WIDTH, mapColorToSDL(255, 255, 255, 255));
-
-    if (control & 0x01) {  // Bit 0 - BG & Window Enable/Priority
-        renderTiles();
-    } else {
-         // If BG is disabled, the screen area is usually white
-         BYTE currentLine = memoryController->read(LY_REGISTER);
-         if (currentLine < VISIBLE_SCANLINES) {
-            Uint32 white = mapColorToSDL(255, 255, 255, 255);
-            size_t startIndex = static_cast<size_t>(currentLine) * SCREEN_PIXELS_WIDTH;
-            std::fill_n(screenBuffer.begin() + startIndex, SCREEN_PIXELS_WIDTH, white);
-         }
+void PPU::debugFillTestPattern() {
+    syncWorker();
+    // Create a test pattern to verify the rendering pipeline
+    for (int y = 0; y < SCREEN_PIXELS_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_PIXELS_WIDTH; x++) {
+            // Darkest and lightest shade checkerboard
+            m_Context.line(y)[x] = ((x / 16 + y / 16) % 2 == 0) ? 3 : 0;
+        }
     }
+    markAllRowsChanged();
+    m_Context.frame = publishFrame(m_PresentedFrames.load(std::memory_order_relaxed));
+    if (m_Worker) {
+        m_Worker->reload(m_Context.frame);
+    }
+    LOG_INFO("Test pattern generated - checksum: " + std::to_string(calculateBufferChecksum()));
+}
 
-    if (control & 0x02) {  // Bit 1 - OBJ (Sprite) Display Enable
-        renderSprites();
+void PPU::setMode(BYTE mode) {
+    BYTE& status = m_State.ioRegister(STAT_REGISTER);
+    status = (status & 0xF8) | (mode & 0x03);
+    if (reg(LY_REGISTER) == reg(LYC_REGISTER)) {
+        status |= STAT_LYC_EQ_LY;
     }
+    currentMode = mode;
 }
 
+bool PPU::isLCDEnabled() const {
+    return (reg(LCD_CONTROL) & LCD_ENABLE_BIT) != 0;
+}
 
 // First, fix the buffer index comparison issue
-void PPU::setPixel(int x, int y, Uint32 color) {
+void PPU::setPixel(int x, int y, BYTE shade) {
      // Add boundary checks for safety
      if (x < 0 || x >= SCREEN_PIXELS_WIDTH || y < 0 || y >= SCREEN_PIXELS_HEIGHT) {
          // LOG_WARNING("setPixel out of bounds: (" + std::to_string(x) + ", " + std::to_string(y) + ")");
          return;
      }
-    size_t bufferIndex = static_cast<size_t>(y) * SCREEN_PIXELS_WIDTH + x;
-    // Check against buffer size (already done in caller, but safe to keep)
-    if (bufferIndex < screenBuffer.size()) {
-        screenBuffer[bufferIndex] = color;
-    } else {
-         // This should ideally not happen if coordinates are checked
-         LOG_ERROR("setPixel buffer index out of range: " + std::to_string(bufferIndex));
-    }
+    m_Context.line(y)[x] = shade;
 }
 
-// Now fix the renderTiles function with proper window handling
-void PPU::renderTiles() {
-    // static int pixels_drawn = 0; // Remove static counter
-    // pixels_drawn++;
-    // if (pixels_drawn % 1000 == 0) {
-    //     LOG_DEBUG("Drawn " + std::to_string(pixels_drawn) + " pixels");
-    // }
-
-    // Add in Emulator::render():
-    // LOG_DEBUG("Updating texture with screen buffer - Checksum: " +
-    //         std::to_string(calculateBufferChecksum())); // Moved logging to render()
-    BYTE lcdControl = memoryController->read(LCD_CONTROL);
-    // if (lcdControl != prevLCDControl) { // Moved to monitorRegisterChanges
-    //     LOG_INFO("LCD Control changed to: 0x" + std::to_string(lcdControl));
-    // }
-
-    BYTE scrollY = memoryController->read(SCY_REGISTER);
-    BYTE scrollX = memoryController->read(SCX_REGISTER);
-
-    // Get current scanline first
-    BYTE currentLine = memoryController->read(LY_REGISTER);
-    if (currentLine >= VISIBLE_SCANLINES) return; // Should not draw outside visible area
-
-    // Window position registers
-    BYTE windowY = memoryController->read(WY_REGISTER);
-    BYTE windowX = memoryController->read(WX_REGISTER) - 7;  // WX is offset by 7
-    bool windowEnabledThisLine = (lcdControl & 0x20) && (lcdControl & 0x01) && windowY <= currentLine; // Window Enable + BG/Win Enable
-
-    // Determine which tile data area to use
-    WORD tileDataArea = (lcdControl & 0x10) ? TILE_DATA_1 : TILE_DATA_2;
-    bool unsignedIndexing = (lcdControl & 0x10); // Tile Data Select (1=8000-8FFF, 0=8800-97FF)
-
-    // Background tile map selection
-    WORD bgTileMap = (lcdControl & 0x08) ? BG_TILE_MAP_2 : BG_TILE_MAP_1;
-
-    // Window tile map selection
-    WORD windowTileMap = (lcdControl & 0x40) ? WINDOW_TILE_MAP_2 : WINDOW_TILE_MAP_1;
-
-    BYTE bgPalette = memoryController->read(BGP_REGISTER);
+void PPU::trackLine(int line, const BYTE* shades, uint32_t frame) {
+    uint64_t hash = hashBytes(shades, SCREEN_PIXELS_WIDTH);
+    if (hash != m_RowHashes[line]) {
+        m_RowHashes[line] = hash;
+        m_RowChanged[line].store(frame, std::memory_order_relaxed);
+        m_FrameChanged = true;
+    }
+}
 
-    // Draw the 160 pixels for this scanline
-    for (int pixel = 0; pixel < SCREEN_PIXELS_WIDTH; pixel++) {
-        bool useWindow = windowEnabledThisLine && pixel >= windowX;
+void PPU::markAllRowsChanged() {
+    uint32_t frame = m_PresentedFrames.load(std::memory_order_relaxed) + 1;
+    for (int row = 0; row < SCREEN_PIXELS_HEIGHT; row++) {
+        m_RowHashes[row] = 0;
+        m_RowChanged[row].store(frame, std::memory_order_relaxed);
+    }
+    m_FrameChanged = true;
+}
 
-        BYTE mapX, mapY;
-        WORD tileMapAddrBase;
-        BYTE tileLineInTile;
+BYTE* PPU::completeFrame(uint32_t sequence) {
+    uint64_t frameHash = hashBytes(reinterpret_cast<const BYTE*>(m_RowHashes), sizeof(m_RowHashes)) ^
+                         hashBytes(reinterpret_cast<const BYTE*>(m_Scheme.shades), sizeof(m_Scheme.shades));
+    m_FrameHash.store(frameHash, std::memory_order_relaxed);
+    if (m_FrameChanged) {
+        m_ChangedFrames.fetch_add(1, std::memory_order_relaxed);
+        m_FrameChanged = false;
+    }
+    return publishFrame(sequence);
+}
 
-        if (useWindow) {
-            mapX = pixel - windowX;
-            mapY = currentLine - windowY; // Y relative to window start
-            tileMapAddrBase = windowTileMap;
-            tileLineInTile = mapY % 8;
-        } else {
-            mapX = pixel + scrollX;
-            mapY = currentLine + scrollY;
-            tileMapAddrBase = bgTileMap;
-            tileLineInTile = mapY % 8;
-        }
+// The engine draws the next frame into the slot it gets back, so every
+// visible row is overwritten before that slot is published again
+BYTE* PPU::publishFrame(uint32_t sequence) {
+    PPUFrame& frame = m_Frames.back();
+    memcpy(frame.palette, m_Scheme.shades, sizeof(frame.palette));
+    frame.sequence = sequence;
+    m_Frames.publish();
+    return m_Frames.back().shades.data();
+}
 
-        // Calculate tile coordinates (32x32 map)
-        BYTE tileX = mapX / 8;
-        BYTE tileY = mapY / 8;
+const PPUFrame& PPU::getLastFrame() {
+    syncWorker();
+    return m_Frames.published();
+}
 
-        // Get the tile index from the appropriate tile map
-        WORD tileMapAddress = tileMapAddrBase + (static_cast<WORD>(tileY) * 32) + tileX;
-        BYTE tileIndex = memoryController->read(tileMapAddress);
+std::vector<Uint32> PPU::getScreenBuffer() {
+    const PPUFrame& frame = getLastFrame();
+    std::vector<Uint32> pixels(frame.shades.size());
+    convertShades(frame.shades.data(), SCREEN_PIXELS_WIDTH, SCREEN_PIXELS_HEIGHT, frame.palette,
+                  FramePixelFormat::RGBA8888, pixels.data(), SCREEN_PIXELS_WIDTH * sizeof(Uint32));
+    return pixels;
+}
 
-        // Calculate tile data address based on indexing mode
-        WORD tileDataAddress;
-        if (unsignedIndexing) { // Use $8000-$8FFF
-            tileDataAddress = TILE_DATA_1 + (static_cast<WORD>(tileIndex) * 16);
-        } else { // Use $8800-$97FF (signed index relative to $9000)
-            tileDataAddress = TILE_DATA_2 + (static_cast<int8_t>(tileIndex) * 16);
-        }
+const PPUFrame& PPU::acquireFrame(bool& fresh) {
+    fresh = m_Frames.acquire();
+    return m_Frames.front();
+}
 
-        // Get the specific line of the tile we need (2 bytes per line)
-        WORD tileLineAddress = tileDataAddress + (static_cast<WORD>(tileLineInTile) * 2);
-        BYTE tileData1 = memoryController->read(tileLineAddress);
-        BYTE tileData2 = memoryController->read(tileLineAddress + 1);
-
-        // Get the specific pixel's color index within the tile line
-        BYTE pixelBit = 7 - (mapX % 8); // Bit position (7=leftmost, 0=rightmost)
-        BYTE colorNum = ((tileData2 >> pixelBit) & 1) << 1; // Bit from second byte
-        colorNum |= ((tileData1 >> pixelBit) & 1);      // Bit from first byte
-
-        // Get the actual color from the background palette
-        BYTE color = (bgPalette >> (colorNum * 2)) & 0x03;
-
-        // Convert palette index to RGBA color
-        Uint32 pixelColor;
-        switch(color) {
-            case 0: pixelColor = mapColorToSDL(255, 255, 255, 255); break; // White
-            case 1: pixelColor = mapColorToSDL(170, 170, 170, 255); break; // Light gray
-            case 2: pixelColor = mapColorToSDL(85, 85, 85, 255);    break; // Dark gray
-            case 3: pixelColor = mapColorToSDL(0, 0, 0, 255);       break; // Black
-            default: pixelColor = mapColorToSDL(255, 0, 255, 255); break;  // Error color (pink)
+bool PPU::getDirtyRows(uint32_t sinceFrame, int& firstRow, int& lastRow) const {
+    firstRow = -1;
+    for (int row = 0; row < SCREEN_PIXELS_HEIGHT; row++) {
+        // Wrap-safe "changed after sinceFrame"
+        if (static_cast<int32_t>(m_RowChanged[row].load(std::memory_order_relaxed) - sinceFrame) > 0) {
+            if (firstRow < 0) {
+                firstRow = row;
+            }
+            lastRow = row;
         }
-
-        // Set the pixel in the buffer
-        setPixel(pixel, currentLine, pixelColor);
     }
+    return firstRow >= 0;
 }
+
 uint32_t PPU::calculateBufferChecksum() {
     uint32_t checksum = 0;
-    for (const auto& pixel : screenBuffer) {
+    for (BYTE pixel : getLastFrame().shades) {
         // A simple checksum algorithm (e.g., Fletcher's checksum or just sum)
         checksum = (checksum + pixel) & 0xFFFFFFFF; // Basic sum, wrap around
     }
     return checksum;
 }
-int PPU::getColorFromPalette(BYTE palette, int colorId) {
-    // This function seems to map palette index (0-3) to grayscale (0, 96, 192, 255)
-    // Let's keep it as is, assuming this is the desired grayscale mapping.
-    // If you want actual colors later, this needs changing.
-    int colorIndex = 0;
-    switch (colorId) {
-        case 0: colorIndex = (palette >> 0) & 0x03; break; // Bits 1-0
-        case 1: colorIndex = (palette >> 2) & 0x03; break; // Bits 3-2
-        case 2: colorIndex = (palette >> 4) & 0x03; break; // Bits 5-4
-        case 3: colorIndex = (palette >> 6) & 0x03; break; // Bits 7-6
-    }
-
-    // Map palette index to grayscale intensity (0=white, 3=black)
-    switch (colorIndex) {
-        case 0: return 255;   // White
-        case 1: return 170;   // Light gray (~192)
-        case 2: return 85;    // Dark gray (~96)
-        case 3: return 0;     // Black
-        default: return 0;    // Should not happen
-    }
-}
 // Add this method to ppu.cpp
 void PPU::monitorRegisterChanges() {
     // Monitor LCD Control changes
-    BYTE lcdControl = memoryController->read(LCD_CONTROL);
+    BYTE lcdControl = reg(LCD_CONTROL);
     if (lcdControl != prevLCDControl) {
         std::stringstream ss;
         ss << "LCD Control changed: 0x" << std::hex << static_cast<int>(prevLCDControl)
@@ -477,7 +556,7 @@ void PPU::monitorRegisterChanges() {
     }
 
     // Monitor background palette changes
-    BYTE bgp = memoryController->read(BGP_REGISTER);
+    BYTE bgp = reg(BGP_REGISTER);
     if (bgp != prevBGP) {
          std::stringstream ss;
          ss << "BGP changed: 0x" << std::hex << static_cast<int>(prevBGP)
@@ -490,134 +569,60 @@ void PPU::monitorRegisterChanges() {
         prevBGP = bgp;
     }
 }
-void PPU::renderSprites() {
-    // static int pixels_drawn = 0; // Remove static counter
-    // pixels_drawn++;
-    // if (pixels_drawn % 1000 == 0) {
-    //     LOG_DEBUG("Drawn " + std::to_string(pixels_drawn) + " pixels");
-    // }
-
-    // Add in Emulator::render():
-    // LOG_DEBUG("Updating texture with screen buffer - Checksum: " +
-    //         std::to_string(calculateBufferChecksum())); // Moved logging to render()
-    BYTE lcdControl = memoryController->read(LCD_CONTROL);
-    // if (lcdControl != prevLCDControl) { // Moved to monitorRegisterChanges
-    //     LOG_INFO("LCD Control changed to: 0x" + std::to_string(lcdControl));
-    // }
-    bool use8x16 = (lcdControl & 0x04) != 0;  // Bit 2: OBJ (Sprite) Size (0=8x8, 1=8x16)
-    int spriteHeight = use8x16 ? 16 : 8;
-
-    BYTE currentLine = memoryController->read(LY_REGISTER);
-    if (currentLine >= VISIBLE_SCANLINES) return; // Don't render sprites outside visible area
-
-    int spritesRenderedThisLine = 0; // DMG PPU can only render 10 sprites per scanline
-
-    // Iterate through OAM (Object Attribute Memory)
-    for (int spriteIndex = 0; spriteIndex < MAX_SPRITES; spriteIndex++) {
-        if (spritesRenderedThisLine >= 10) break; // Stop after 10 sprites
-
-        // Calculate the address of the sprite's attributes
-        WORD spriteAddress = OAM_START + (static_cast<WORD>(spriteIndex) * SPRITE_ATTRIBUTE_SIZE);
-
-        // Read the sprite's attributes
-        BYTE yPos = memoryController->read(spriteAddress + SPRITE_Y_POS); // Screen Y = yPos - 16
-        BYTE xPos = memoryController->read(spriteAddress + SPRITE_X_POS); // Screen X = xPos - 8
-        BYTE tileIndex = memoryController->read(spriteAddress + SPRITE_TILE_INDEX);
-        BYTE attributes = memoryController->read(spriteAddress + SPRITE_ATTRIBUTES);
-
-        // Adjust for screen coordinates
-        int screenY = yPos - 16;
-        int screenX = xPos - 8;
-
-        // Is the sprite visible on this scanline?
-        if (currentLine >= screenY && currentLine < (screenY + spriteHeight)) {
-            spritesRenderedThisLine++; // Count this sprite
-
-            bool yFlip = (attributes & SPRITE_Y_FLIP) != 0;
-            bool xFlip = (attributes & SPRITE_X_FLIP) != 0;
-            bool bgPriority = (attributes & SPRITE_PRIORITY) != 0; // Bit 7: BG and Window over OBJ
-            bool paletteNumber = (attributes & SPRITE_PALETTE) != 0;  // Bit 4: Palette Number (0=OBP0, 1=OBP1)
-
-            // Determine the palette address
-            WORD paletteAddress = paletteNumber ? OBP1_REGISTER : OBP0_REGISTER;
-            BYTE obp = memoryController->read(paletteAddress);
-
-            // Calculate the line within the sprite tile(s)
-            int lineInSprite = currentLine - screenY;
-            if (yFlip) {
-                lineInSprite = spriteHeight - 1 - lineInSprite;
-            }
-
-            // Adjust tile index for 8x16 sprites
-            if (use8x16) {
-                tileIndex &= 0xFE; // Mask LSB for 8x16 sprites
-                if (lineInSprite >= 8) {
-                    tileIndex |= 0x01; // Use the bottom tile if needed
-                    lineInSprite -= 8;
-                }
-            }
-
-            // Calculate the address of the tile data in VRAM ($8000-$8FFF)
-            WORD tileDataAddress = TILE_DATA_1 + (static_cast<WORD>(tileIndex) * 16) + (static_cast<WORD>(lineInSprite) * 2);
-
-            // Read the two bytes for the tile line
-            BYTE data1 = memoryController->read(tileDataAddress);
-            BYTE data2 = memoryController->read(tileDataAddress + 1);
-
-            // Render the 8 horizontal pixels for this sprite line
-            for (int tilePixelX = 0; tilePixelX < 8; tilePixelX++) {
-                // Calculate the final screen X coordinate for this pixel
-                int pixelX = screenX + tilePixelX;
-
-                // Skip if pixel is off-screen horizontally
-                if (pixelX < 0 || pixelX >= SCREEN_PIXELS_WIDTH) {
-                    continue;
-                }
-
-                // Determine the bit position within the tile data bytes (7=left, 0=right)
-                int colorBit = xFlip ? tilePixelX : (7 - tilePixelX);
-
-                // Extract the 2-bit color number (0-3)
-                BYTE colorNum = ((data2 >> colorBit) & 1) << 1;
-                colorNum |= ((data1 >> colorBit) & 1);
-
-                // Color number 0 is transparent for sprites
-                if (colorNum == 0) {
-                    continue;
-                }
-
-                // Check BG Priority attribute
-                if (bgPriority) {
-                    // Check if the underlying BG/Window pixel is non-zero (not color 0)
-                    size_t bgBufferIndex = static_cast<size_t>(currentLine) * SCREEN_PIXELS_WIDTH + pixelX;
-                    // Need to convert the existing pixel color back to a palette index/number
-                    // This requires knowing the BG palette used for that pixel.
-                    // For simplicity, often emulators check if the BG color is != white (color 0)
-                    // This isn't perfectly accurate but often works.
-                    // A more accurate way involves storing the BG color index per pixel.
-                    // Let's assume for now: if BG pixel is not white, sprite is hidden.
-                    if (bgBufferIndex < screenBuffer.size() && screenBuffer[bgBufferIndex] != mapColorToSDL(255, 255, 255, 255)) {
-                         continue; // BG pixel has priority, skip drawing sprite pixel
-                    }
-                }
 
+std::vector<PPUEngineTiming> benchmarkPPUEngines(int frames) {
+    auto memory = std::make_shared<MemoryController>();
+    MachineState& state = memory->state();
 
-                // Get the actual color index (0-3) from the selected object palette
-                BYTE colorIndex = (obp >> (colorNum * 2)) & 0x03;
-
-                // Map the color index to a display color (using grayscale for now)
-                int grayColor = 0;
-                 switch (colorIndex) {
-                     case 0: grayColor = 255; break; // White (Should be transparent, handled above)
-                     case 1: grayColor = 170; break; // Light gray
-                     case 2: grayColor = 85; break;  // Dark gray
-                     case 3: grayColor = 0; break;   // Black
-                 }
-                 Uint32 rgbaColor = mapColorToSDL(grayColor, grayColor, grayColor, 255);
-
-                // Set the pixel in the buffer
-                setPixel(pixelX, currentLine, rgbaColor);
+    // Random tile data and maps, 40 8x16 sprites spread down the screen
+    uint32_t seed = 0x12345678;
+    for (BYTE& byte : state.vram) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<BYTE>(seed >> 24);
+    }
+    for (int sprite = 0; sprite < MAX_SPRITES; sprite++) {
+        BYTE* attributes = state.oam + sprite * SPRITE_ATTRIBUTE_SIZE;
+        attributes[SPRITE_Y_POS] = static_cast<BYTE>(16 + sprite * VISIBLE_SCANLINES / MAX_SPRITES);
+        attributes[SPRITE_X_POS] = static_cast<BYTE>(8 + (sprite * 37) % SCREEN_PIXELS_WIDTH);
+        attributes[SPRITE_TILE_INDEX] = static_cast<BYTE>(sprite * 5);
+        attributes[SPRITE_ATTRIBUTES] = static_cast<BYTE>((sprite & 7) << 4);
+    }
+    state.ioRegister(SCY_REGISTER) = 5;
+    state.ioRegister(SCX_REGISTER) = 3;
+    state.ioRegister(WY_REGISTER) = 72;
+    state.ioRegister(WX_REGISTER) = 87;
+    state.ioRegister(BGP_REGISTER) = 0xE4;
+    state.ioRegister(OBP0_REGISTER) = 0xD2;
+    state.ioRegister(OBP1_REGISTER) = 0x6C;
+    state.ioRegister(LCD_CONTROL) = 0xF7;  // LCD, window (0x9C00), 0x8000 tiles, 8x16 OBJ, OBJ, BG
+
+    PPU ppu(memory);
+    Scheduler& scheduler = memory->scheduler();
+    std::vector<PPUEngineTiming> results;
+    struct Run {
+        PPUEngineKind kind;
+        bool threaded;
+    };
+    for (Run run : { Run{ PPUEngineKind::SCANLINE, false }, Run{ PPUEngineKind::SCANLINE, true },
+                     Run{ PPUEngineKind::FIFO, false } }) {
+        ppu.setEngine(run.kind);
+        ppu.setRenderThread(run.threaded, ThreadPlacementConfig());
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (int line = 0; line < TOTAL_SCANLINES; line++) {
+                scheduler.advance(SCANLINE_CYCLES);
+                ppu.catchUp();
             }
         }
+        ppu.getLastFrame();  // Waits for the worker
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+        PPUEngineTiming timing{ run.kind, ppu.isRenderThreaded(), elapsed.count() / frames };
+        results.push_back(timing);
+        LOG_INFO(std::string(ppuEngineName(run.kind)) + (timing.threaded ? " (worker)" : "") + ": " +
+                 std::to_string(timing.usPerFrame) + " us/frame (" +
+                 std::to_string(static_cast<int>(1000000.0 / timing.usPerFrame)) + " frames/s, PPU only)");
     }
+    ppu.setRenderThread(false, ThreadPlacementConfig());
+    return results;
 }
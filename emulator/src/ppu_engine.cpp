@@ -0,0 +1,26 @@
+#include <ppu_engine.h>
+#include <accuracy_policy.h>
+#include <logger.h>
+
+const char* ppuEngineName(PPUEngineKind kind) {
+    return kind == PPUEngineKind::FIFO ? "fifo" : "scanline";
+}
+
+PPUEngineKind ppuEngineForRom(const std::string& configPath, const std::string& romPath, const std::string& romTitle) {
+    std::string value = GB::romConfigValue(configPath, romPath, romTitle);
+    if (value.empty() || value == ppuEngineName(PPUEngineKind::SCANLINE)) {
+        return PPUEngineKind::SCANLINE;
+    }
+    if (value == ppuEngineName(PPUEngineKind::FIFO)) {
+        return PPUEngineKind::FIFO;
+    }
+    LOG_WARNING(configPath + ": unknown PPU engine '" + value + "', using scanline");
+    return PPUEngineKind::SCANLINE;
+}
+
+std::unique_ptr<PPUEngine> createPPUEngine(PPUEngineKind kind, const PPURenderContext& context) {
+    if (kind == PPUEngineKind::FIFO) {
+        return std::make_unique<FifoEngine>(context);
+    }
+    return std::make_unique<ScanlineEngine>(context);
+}
@@ -0,0 +1,186 @@
+#include <ppu_worker.h>
+#include <cstring>
+
+namespace {
+constexpr int IDLE_SPINS = 2000;        // Yields before the worker sleeps; lines arrive every few us when uncapped
+}
+
+PPUWorker::PPUWorker(ByteSpan vram, ByteSpan oam, const PixelKernels& kernels, const ThreadPlacementConfig& placement,
+                     BYTE* frame, LineDone lineDone, FrameDone frameDone)
+    : m_VRAM(vram.begin(), vram.end())
+    , m_OAM(oam.begin(), oam.end())
+    , m_Registers{}
+    , m_BGShades{}
+    , m_OBJShades{}
+    , m_TileCache(ByteSpan(m_VRAM.data(), m_VRAM.size()))
+    , m_SpriteLines(ByteSpan(m_OAM.data(), m_OAM.size()))
+    , m_Context{ByteSpan(m_VRAM.data(), m_VRAM.size()), ByteSpan(m_Registers, LCD_REGISTER_COUNT),
+                ByteSpan(m_OAM.data(), m_OAM.size()), m_TileCache, m_SpriteLines, kernels,
+                m_BGShades, m_OBJShades, frame}
+    , m_Engine(m_Context)
+    , m_LineDone(std::move(lineDone))
+    , m_FrameDone(std::move(frameDone))
+    , m_SourceVRAM(vram)
+    , m_SourceOAM(oam)
+    , m_SentOAM(oam.begin(), oam.end())
+    , m_OAMChanged(false)
+    , m_WriteIndex(0)
+    , m_CachedHead(0)
+    , m_Queue(QUEUE_SIZE)
+    , m_Placement(placement)
+{
+    m_Thread = std::thread(&PPUWorker::run, this);
+}
+
+PPUWorker::~PPUWorker() {
+    flush();
+    m_Stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Wake.notify_one();
+    }
+    m_Thread.join();
+}
+
+void PPUWorker::onVRAMWrite(WORD address) {
+    Command command = {};
+    command.kind = VRAM_WRITE;
+    command.offset = static_cast<WORD>(address - 0x8000);
+    command.value = m_SourceVRAM[command.offset];
+    push(command);
+}
+
+void PPUWorker::drawLine(int line, uint32_t frame, ByteSpan lcdRegisters, const BYTE* bgShades, const BYTE (*objShades)[4]) {
+    if (m_OAMChanged) {
+        sendOAMChanges();
+    }
+    Command command = {};
+    command.kind = DRAW_LINE;
+    command.value = static_cast<BYTE>(line);
+    command.frame = frame;
+    memcpy(command.registers, lcdRegisters.data(), LCD_REGISTER_COUNT);
+    memcpy(command.bgShades, bgShades, sizeof(command.bgShades));
+    memcpy(command.objShades, objShades, sizeof(command.objShades));
+    push(command);
+    flush();
+}
+
+void PPUWorker::publishFrame(uint32_t sequence) {
+    Command command = {};
+    command.kind = PUBLISH;
+    command.frame = sequence;
+    push(command);
+    flush();
+}
+
+void PPUWorker::sync() {
+    flush();
+    while (m_Head.load(std::memory_order_acquire) != m_WriteIndex) {
+        std::this_thread::yield();
+    }
+    m_CachedHead = m_WriteIndex;
+}
+
+void PPUWorker::reload(BYTE* frame) {
+    sync();
+    memcpy(m_VRAM.data(), m_SourceVRAM.data(), m_VRAM.size());
+    memcpy(m_OAM.data(), m_SourceOAM.data(), m_OAM.size());
+    memcpy(m_SentOAM.data(), m_SourceOAM.data(), m_SentOAM.size());
+    m_OAMChanged = false;
+    m_TileCache.invalidateAll();
+    m_SpriteLines.invalidate();
+    m_Context.frame = frame;
+}
+
+// A DMA rewrites all of OAM but usually changes a few bytes; only those are sent
+void PPUWorker::sendOAMChanges() {
+    m_OAMChanged = false;
+    for (size_t i = 0; i < m_SentOAM.size(); i++) {
+        if (m_SourceOAM[i] != m_SentOAM[i]) {
+            m_SentOAM[i] = m_SourceOAM[i];
+            Command command = {};
+            command.kind = OAM_WRITE;
+            command.offset = static_cast<WORD>(i);
+            command.value = m_SentOAM[i];
+            push(command);
+        }
+    }
+}
+
+void PPUWorker::push(const Command& command) {
+    if (m_WriteIndex - m_CachedHead >= QUEUE_SIZE) {
+        // Full: let the worker see what is there and wait for room
+        flush();
+        while (m_WriteIndex - (m_CachedHead = m_Head.load(std::memory_order_acquire)) >= QUEUE_SIZE) {
+            std::this_thread::yield();
+        }
+    }
+    m_Queue[m_WriteIndex & (QUEUE_SIZE - 1)] = command;
+    m_WriteIndex++;
+}
+
+// m_Tail and m_Sleeping are sequentially consistent on both sides, so either
+// the worker sees the new tail before it sleeps or this sees it sleeping
+void PPUWorker::flush() {
+    m_Tail.store(m_WriteIndex);
+    if (m_Sleeping.load()) {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Wake.notify_one();
+    }
+}
+
+void PPUWorker::run() {
+    placeCurrentThread(m_Placement, ThreadRole::WORKER);
+    uint32_t head = m_Head.load(std::memory_order_relaxed);
+    int idle = 0;
+    while (true) {
+        uint32_t tail = m_Tail.load();
+        if (head != tail) {
+            while (head != tail) {
+                execute(m_Queue[head & (QUEUE_SIZE - 1)]);
+                head++;
+                m_Head.store(head, std::memory_order_release);
+            }
+            idle = 0;
+            continue;
+        }
+        if (m_Stop.load()) {
+            break;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        m_Sleeping.store(true);
+        m_Wake.wait(lock, [this, head]() { return m_Tail.load() != head || m_Stop.load(); });
+        m_Sleeping.store(false);
+        idle = 0;
+    }
+}
+
+void PPUWorker::execute(const Command& command) {
+    switch (command.kind) {
+        case VRAM_WRITE:
+            m_VRAM[command.offset] = command.value;
+            m_TileCache.invalidate(static_cast<WORD>(0x8000 + command.offset));
+            break;
+
+        case OAM_WRITE:
+            m_OAM[command.offset] = command.value;
+            m_SpriteLines.invalidate();
+            break;
+
+        case DRAW_LINE:
+            memcpy(m_Registers, command.registers, sizeof(m_Registers));
+            memcpy(m_BGShades, command.bgShades, sizeof(m_BGShades));
+            memcpy(m_OBJShades, command.objShades, sizeof(m_OBJShades));
+            m_Engine.beginLine(command.value);
+            m_LineDone(command.value, m_Context.line(command.value), command.frame);
+            break;
+
+        case PUBLISH:
+            m_Context.frame = m_FrameDone(command.frame);
+            break;
+    }
+}
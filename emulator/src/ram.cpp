@@ -1,32 +1,33 @@
 #include <logger.h>
 #include "ram.h"
 #include <string>
-RAM::RAM()
+RAM::RAM(MachineState& state)
+    : m_State(state)
 {
-    memset(this->m_memory,0,sizeof(m_memory));
 }
 
 RAM::~RAM()
 {
 }
 
-BYTE RAM::read(WORD address) const {
-    // Check for invalid addresses
-    if (address >= RAM_SIZE) {
-        LOG_ERROR("Attempted read from invalid address: 0x" + 
-                 std::to_string(address));
-        return BYTE_MASK;
-    }
+BYTE* RAM::locate(WORD address) {
+    return const_cast<BYTE*>(static_cast<const RAM*>(this)->locate(address));
+}
 
-    // Special handling for Echo RAM (0xE000-0xFDFF mirrors 0xC000-0xDDFF)
-    if (address >= 0xE000 && address < 0xFE00) {
-        WORD mirrorAddr = address - 0x2000;
-        LOG_DEBUG("Echo RAM read - Mirror address 0x" + 
-                 std::to_string(mirrorAddr) + " -> 0x" + 
-                 std::to_string(address));
-        return m_memory[mirrorAddr];
-    }
+const BYTE* RAM::locate(WORD address) const {
+    if (address < 0x8000) return nullptr;                                   // ROM window
+    if (address < 0xA000) return &m_State.vram[address - 0x8000];
+    if (address < 0xC000) return nullptr;                                   // External RAM (banked)
+    if (address < 0xE000) return &m_State.wram[address - 0xC000];
+    if (address < 0xFE00) return &m_State.wram[address - 0xE000];           // Echo of 0xC000-0xDDFF
+    if (address < 0xFEA0) return &m_State.oam[address - 0xFE00];
+    if (address < 0xFF00) return nullptr;                                   // Restricted
+    if (address < 0xFF80) return &m_State.io[address - 0xFF00];
+    if (address < 0xFFFF) return &m_State.hram[address - 0xFF80];
+    return &m_State.interruptEnable;
+}
 
+BYTE RAM::read(WORD address) const {
     // Restricted area (0xFEA0-0xFEFF)
     if (address >= 0xFEA0 && address <= 0xFEFF) {
         LOG_WARNING("Read attempt from restricted area: 0x" + 
@@ -34,18 +35,16 @@ BYTE RAM::read(WORD address) const {
         return BYTE_MASK;
     }
 
-    return m_memory[address];
+    const BYTE* location = locate(address);
+    if (!location) {
+        LOG_ERROR("Attempted read from unmapped address: 0x" + 
+                 std::to_string(address));
+        return BYTE_MASK;
+    }
+    return *location;
 }
 
 void RAM::write(WORD address, BYTE data) {
-    // Check for invalid addresses
-    if (address >= RAM_SIZE) {
-        LOG_ERROR("Attempted write to invalid address: 0x" + 
-                 std::to_string(address) + " with data: 0x" + 
-                 std::to_string(data));
-        return;
-    }
-
     // ROM area (0x0000-0x7FFF)
     if (address < 0x8000) {
         LOG_WARNING("Attempted write to ROM area: 0x" + 
@@ -54,15 +53,6 @@ void RAM::write(WORD address, BYTE data) {
         return;
     }
 
-    // Echo RAM (0xE000-0xFDFF mirrors 0xC000-0xDDFF)
-    if (address >= 0xE000 && address < 0xFE00) {
-        WORD mirrorAddr = address - 0x2000;
-        m_memory[mirrorAddr] = data;
-        LOG_DEBUG("Echo RAM write - Mirror address 0x" + 
-                 std::to_string(mirrorAddr) + " <- 0x" + 
-                 std::to_string(data));
-    }
-
     // Restricted area (0xFEA0-0xFEFF)
     if (address >= 0xFEA0 && address <= 0xFEFF) {
         LOG_WARNING("Write attempt to restricted area: 0x" + 
@@ -71,5 +61,12 @@ void RAM::write(WORD address, BYTE data) {
         return;
     }
 
-    m_memory[address] = data;
+    BYTE* location = locate(address);
+    if (!location) {
+        LOG_ERROR("Attempted write to unmapped address: 0x" + 
+                 std::to_string(address) + " with data: 0x" + 
+                 std::to_string(data));
+        return;
+    }
+    *location = data;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <rom_image.h>
+#include <logger.h>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI  // wingdi.h defines ERROR, which clashes with LogLevel::ERROR
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+RomImage::~RomImage() {
+    if (!m_Mapping) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_Mapping);
+#else
+    munmap(m_Mapping, m_Size);
+#endif
+}
+
+RomImageRegistry& RomImageRegistry::getInstance() {
+    static RomImageRegistry instance;
+    return instance;
+}
+
+// 64-bit FNV-1a over the whole image
+uint64_t RomImageRegistry::hashContents(const BYTE* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::unique_ptr<RomImage> RomImageRegistry::loadImage(const std::string& filename) {
+    std::unique_ptr<RomImage> image(new RomImage());
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);  // The view keeps the mapping alive
+                if (view) {
+                    image->m_Mapping = view;
+                    image->m_Size = static_cast<size_t>(fileSize.QuadPart);
+                }
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                image->m_Mapping = view;
+                image->m_Size = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    if (image->m_Mapping) {
+        image->m_Data = static_cast<const BYTE*>(image->m_Mapping);
+        return image;
+    }
+
+    // Mapping unavailable - fall back to a private heap copy
+    LOG_WARNING("Could not map ROM file, reading it instead: " + filename);
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Failed to open ROM file: " + filename);
+        return nullptr;
+    }
+    file.seekg(0, std::ios::end);
+    std::streampos fileSize = file.tellg();
+    if (fileSize <= 0) {
+        LOG_ERROR("Invalid ROM file size: " + std::to_string(fileSize));
+        return nullptr;
+    }
+    image->m_Storage.resize(static_cast<size_t>(fileSize));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(image->m_Storage.data()), fileSize);
+    if (!file || file.gcount() != fileSize) {
+        LOG_ERROR("Failed to read ROM file completely: " + filename + " (Read " + std::to_string(file.gcount()) + " bytes)");
+        return nullptr;
+    }
+    image->m_Data = image->m_Storage.data();
+    image->m_Size = image->m_Storage.size();
+    return image;
+}
+
+std::shared_ptr<const RomImage> RomImageRegistry::acquire(const std::string& filename) {
+    std::unique_ptr<RomImage> loaded = loadImage(filename);
+    if (!loaded) {
+        return nullptr;
+    }
+    loaded->m_Hash = hashContents(loaded->m_Data, loaded->m_Size);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    purgeExpired();
+
+    auto it = m_Images.find(loaded->m_Hash);
+    if (it != m_Images.end()) {
+        std::shared_ptr<const RomImage> existing = it->second.lock();
+        if (existing && existing->size() == loaded->m_Size &&
+            memcmp(existing->data(), loaded->m_Data, loaded->m_Size) == 0) {
+            // Same content already resident - drop the new copy and share
+            return existing;
+        }
+        if (existing) {
+            // Hash collision between different ROMs: keep the new one private
+            LOG_WARNING("ROM hash collision, not sharing image for: " + filename);
+            return std::shared_ptr<const RomImage>(std::move(loaded));
+        }
+    }
+
+    std::shared_ptr<const RomImage> image(std::move(loaded));
+    m_Images[image->hash()] = image;
+    LOG_INFO("ROM image registered (" + std::to_string(image->size()) + " bytes, " +
+             (image->isMapped() ? "mapped" : "heap") + ")");
+    return image;
+}
+
+void RomImageRegistry::purgeExpired() {
+    for (auto it = m_Images.begin(); it != m_Images.end();) {
+        if (it->second.expired()) {
+            it = m_Images.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t RomImageRegistry::imageCount() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    purgeExpired();
+    return m_Images.size();
+}
+
+size_t RomImageRegistry::residentBytes() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    size_t total = 0;
+    for (const auto& entry : m_Images) {
+        if (std::shared_ptr<const RomImage> image = entry.second.lock()) {
+            total += image->size();
+        }
+    }
+    return total;
+}
@@ -0,0 +1,135 @@
+#include <ppu_engine.h>
+#include <algorithm>
+#include <cstring>
+
+ScanlineEngine::ScanlineEngine(const PPURenderContext& context)
+    : m_Context(context)
+{
+    memset(m_BGLine, 0, sizeof(m_BGLine));
+}
+
+int ScanlineEngine::transferCycles(int /*line*/) {
+    return MODE_3_CYCLES;
+}
+
+void ScanlineEngine::beginLine(int line) {
+    BYTE control = m_Context.reg(LCD_CONTROL);
+
+    if (control & 0x01) {  // Bit 0 - BG & Window Enable/Priority
+        renderTiles(line);
+    } else {
+        // If BG is disabled, the screen area shows the lightest shade
+        memset(m_Context.line(line), 0, SCREEN_PIXELS_WIDTH);
+        memset(m_BGLine, 0, sizeof(m_BGLine));  // Sprites are never hidden by a disabled BG
+    }
+
+    if (control & 0x02) {  // Bit 1 - OBJ (Sprite) Display Enable
+        renderSprites(line);
+    }
+}
+
+// Copies `count` colour indices of tile map row mapY, starting at mapX, from
+// the decoded tiles. mapX wraps at the 256-pixel map edge.
+void ScanlineEngine::fetchTileRow(WORD tileMap, BYTE mapX, BYTE mapY, bool unsignedIndexing, BYTE* out, int count) {
+    const BYTE* mapRow = m_Context.vram.data() + (tileMap - 0x8000) + (mapY / TILE_HEIGHT) * 32;
+    int tileLine = mapY % TILE_HEIGHT;
+    while (count > 0) {
+        int tile = TileCache::tileNumber(mapRow[mapX / TILE_WIDTH], unsignedIndexing);
+        const BYTE* row = m_Context.tiles.row(tile, tileLine);
+        int first = mapX % TILE_WIDTH;
+        int pixels = std::min(TILE_WIDTH - first, count);
+        memcpy(out, row + first, pixels);
+        out += pixels;
+        count -= pixels;
+        mapX = static_cast<BYTE>(mapX + pixels);
+    }
+}
+
+void ScanlineEngine::renderTiles(int line) {
+    BYTE lcdControl = m_Context.reg(LCD_CONTROL);
+    BYTE scrollY = m_Context.reg(SCY_REGISTER);
+    BYTE scrollX = m_Context.reg(SCX_REGISTER);
+
+    // Window position registers
+    BYTE windowY = m_Context.reg(WY_REGISTER);
+    BYTE windowX = m_Context.reg(WX_REGISTER) - 7;  // WX is offset by 7
+    bool windowEnabledThisLine = (lcdControl & 0x20) && (lcdControl & 0x01) && windowY <= line; // Window Enable + BG/Win Enable
+    int windowStart = windowEnabledThisLine ? std::min<int>(windowX, SCREEN_PIXELS_WIDTH) : SCREEN_PIXELS_WIDTH;
+
+    bool unsignedIndexing = (lcdControl & 0x10); // Tile Data Select (1=8000-8FFF, 0=8800-97FF)
+    WORD bgTileMap = (lcdControl & 0x08) ? BG_TILE_MAP_2 : BG_TILE_MAP_1;
+    WORD windowTileMap = (lcdControl & 0x40) ? WINDOW_TILE_MAP_2 : WINDOW_TILE_MAP_1;
+
+    // Background up to the window, window for the rest of the line
+    fetchTileRow(bgTileMap, scrollX, static_cast<BYTE>(line + scrollY), unsignedIndexing, m_BGLine, windowStart);
+    if (windowStart < SCREEN_PIXELS_WIDTH) {
+        fetchTileRow(windowTileMap, 0, static_cast<BYTE>(line - windowY), unsignedIndexing,
+                     m_BGLine + windowStart, SCREEN_PIXELS_WIDTH - windowStart);
+    }
+
+    // Colour indices through BGP to shades
+    m_Context.kernels.mapIndices(m_BGLine, SCREEN_PIXELS_WIDTH, m_Context.bgShades, m_Context.line(line));
+}
+
+void ScanlineEngine::renderSprites(int line) {
+    BYTE lcdControl = m_Context.reg(LCD_CONTROL);
+    bool use8x16 = (lcdControl & 0x04) != 0;  // Bit 2: OBJ (Sprite) Size (0=8x8, 1=8x16)
+    int spriteHeight = use8x16 ? 16 : 8;
+
+    // Highest priority first: the first opaque sprite pixel claims the dot,
+    // even when BG priority then hides it behind the background
+    const SpriteLine& sprites = m_Context.sprites.line(line, spriteHeight);
+    bool claimed[SCREEN_PIXELS_WIDTH] = {};
+    BYTE* out = m_Context.line(line);
+
+    for (int i = 0; i < sprites.count; i++) {
+        const BYTE* sprite = m_Context.oam.data() + sprites.sprites[i] * SPRITE_ATTRIBUTE_SIZE;
+        int screenY = sprite[SPRITE_Y_POS] - 16;
+        int screenX = sprite[SPRITE_X_POS] - 8;
+        BYTE tileIndex = sprite[SPRITE_TILE_INDEX];
+        BYTE attributes = sprite[SPRITE_ATTRIBUTES];
+
+        bool yFlip = (attributes & SPRITE_Y_FLIP) != 0;
+        bool xFlip = (attributes & SPRITE_X_FLIP) != 0;
+        bool bgPriority = (attributes & SPRITE_PRIORITY) != 0; // Bit 7: BG and Window colours 1-3 over OBJ
+        const BYTE* shades = m_Context.objShades[(attributes & SPRITE_PALETTE) ? 1 : 0];
+
+        // Calculate the line within the sprite tile(s)
+        int lineInSprite = line - screenY;
+        if (yFlip) {
+            lineInSprite = spriteHeight - 1 - lineInSprite;
+        }
+
+        // Adjust tile index for 8x16 sprites
+        if (use8x16) {
+            tileIndex &= 0xFE; // Mask LSB for 8x16 sprites
+            if (lineInSprite >= 8) {
+                tileIndex |= 0x01; // Use the bottom tile if needed
+                lineInSprite -= 8;
+            }
+        }
+
+        // Sprites always use $8000 addressing
+        const BYTE* tileRow = m_Context.tiles.row(tileIndex, lineInSprite);
+
+        for (int tilePixelX = 0; tilePixelX < 8; tilePixelX++) {
+            int pixelX = screenX + tilePixelX;
+            if (pixelX < 0 || pixelX >= SCREEN_PIXELS_WIDTH || claimed[pixelX]) {
+                continue;
+            }
+
+            // Color number 0 is transparent for sprites
+            BYTE colorNum = tileRow[xFlip ? (7 - tilePixelX) : tilePixelX];
+            if (colorNum == 0) {
+                continue;
+            }
+            claimed[pixelX] = true;
+
+            // Decided on the BG colour index, not the shade BGP maps it to
+            if (bgPriority && m_BGLine[pixelX] != 0) {
+                continue;
+            }
+            out[pixelX] = shades[colorNum];
+        }
+    }
+}
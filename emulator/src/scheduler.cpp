@@ -0,0 +1,65 @@
+#include <scheduler.h>
+#include <logger.h>
+
+Scheduler::Scheduler(SchedulerState& state)
+    : m_State(state)
+{
+    reset();
+}
+
+void Scheduler::setHandler(SchedulerEvent event, Handler handler) {
+    m_Handlers[static_cast<int>(event)] = std::move(handler);
+}
+
+void Scheduler::scheduleAt(SchedulerEvent event, uint64_t cycle) {
+    m_State.deadlines[static_cast<int>(event)] = cycle;
+    if (cycle < m_State.nextDeadline) {
+        m_State.nextDeadline = cycle;
+    } else {
+        updateNextDeadline();  // The event may have been the earliest one
+    }
+}
+
+void Scheduler::cancel(SchedulerEvent event) {
+    m_State.deadlines[static_cast<int>(event)] = NO_DEADLINE;
+    updateNextDeadline();
+}
+
+void Scheduler::updateNextDeadline() {
+    uint64_t next = NO_DEADLINE;
+    for (int i = 0; i < SCHEDULER_EVENT_COUNT; ++i) {
+        if (m_State.deadlines[i] < next) {
+            next = m_State.deadlines[i];
+        }
+    }
+    m_State.nextDeadline = next;
+}
+
+void Scheduler::runDueEvents() {
+    while (m_State.now >= m_State.nextDeadline) {
+        // Pick the earliest due event (few kinds, a scan beats a heap here)
+        int due = 0;
+        for (int i = 1; i < SCHEDULER_EVENT_COUNT; ++i) {
+            if (m_State.deadlines[i] < m_State.deadlines[due]) {
+                due = i;
+            }
+        }
+        uint64_t deadline = m_State.deadlines[due];
+        m_State.deadlines[due] = NO_DEADLINE;
+        updateNextDeadline();
+
+        if (m_Handlers[due]) {
+            m_Handlers[due](deadline);
+        } else {
+            LOG_WARNING("Scheduler event " + std::to_string(due) + " fired with no handler");
+        }
+    }
+}
+
+void Scheduler::reset() {
+    m_State.now = 0;
+    for (int i = 0; i < SCHEDULER_EVENT_COUNT; ++i) {
+        m_State.deadlines[i] = NO_DEADLINE;
+    }
+    m_State.nextDeadline = NO_DEADLINE;
+}
@@ -0,0 +1,45 @@
+#include <sprite_lines.h>
+#include <algorithm>
+
+SpriteLines::SpriteLines(ByteSpan oam)
+    : m_OAM(oam.data())
+    , m_Dirty(true)
+    , m_Height(0)
+{
+}
+
+void SpriteLines::rebuild(int spriteHeight) {
+    for (SpriteLine& line : m_Lines) {
+        line.count = 0;
+    }
+
+    // Selection: OAM order, ten per line
+    for (int sprite = 0; sprite < MAX_SPRITES; sprite++) {
+        int top = m_OAM[sprite * SPRITE_ATTRIBUTE_SIZE + SPRITE_Y_POS] - 16;
+        int first = std::max(top, 0);
+        int last = std::min(top + spriteHeight, static_cast<int>(VISIBLE_SCANLINES));
+        for (int y = first; y < last; y++) {
+            SpriteLine& line = m_Lines[y];
+            if (line.count < MAX_SPRITES_PER_LINE) {
+                line.sprites[line.count++] = static_cast<BYTE>(sprite);
+            }
+        }
+    }
+
+    // Priority: insertion sort by X keeps OAM order among equal X
+    for (SpriteLine& line : m_Lines) {
+        for (int i = 1; i < line.count; i++) {
+            BYTE sprite = line.sprites[i];
+            BYTE x = m_OAM[sprite * SPRITE_ATTRIBUTE_SIZE + SPRITE_X_POS];
+            int j = i;
+            while (j > 0 && m_OAM[line.sprites[j - 1] * SPRITE_ATTRIBUTE_SIZE + SPRITE_X_POS] > x) {
+                line.sprites[j] = line.sprites[j - 1];
+                j--;
+            }
+            line.sprites[j] = sprite;
+        }
+    }
+
+    m_Height = spriteHeight;
+    m_Dirty = false;
+}
@@ -0,0 +1,310 @@
+#include <thread_placement.h>
+#include <config_file.h>
+#include <logger.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace {
+constexpr int64_t NS_PER_MINUTE = 60LL * 1000000000LL;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// "0,2-3" -> {0, 2, 3}
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        item = trimConfigText(item);
+        size_t dash = item.find('-');
+        try {
+            size_t used = 0;
+            int first = std::stoi(item, &used);
+            int last = first;
+            if (dash != std::string::npos) {
+                last = std::stoi(item.substr(dash + 1));
+            } else if (used != item.size()) {
+                return false;
+            }
+            if (first < 0 || last < first) {
+                return false;
+            }
+            for (int cpu = first; cpu <= last; cpu++) {
+                parsed.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    cpus = std::move(parsed);
+    return true;
+}
+
+const char* roleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::EMULATION: return "emulation";
+        case ThreadRole::RENDER: return "render";
+        case ThreadRole::WORKER: return "worker";
+    }
+    return "unknown";
+}
+
+std::string cpuListText(const std::vector<int>& cpus) {
+    std::string text;
+    for (int cpu : cpus) {
+        text += (text.empty() ? "" : ",") + std::to_string(cpu);
+    }
+    return text;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus, const char* name) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+        LOG_WARNING(std::string("Could not pin ") + name + " thread to CPUs " + cpuListText(cpus) + ": " + std::strerror(error));
+        return false;
+    }
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    if (mask == 0 || SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+        LOG_WARNING(std::string("Could not pin ") + name + " thread to CPUs " + cpuListText(cpus));
+        return false;
+    }
+#else
+    LOG_WARNING(std::string("CPU pinning is not supported on this platform, ") + name + " thread left unpinned");
+    return false;
+#endif
+    LOG_INFO(std::string("Pinned ") + name + " thread to CPUs " + cpuListText(cpus));
+    return true;
+}
+
+bool makeCurrentThreadRealtime(int priority) {
+#if defined(__linux__)
+    sched_param param{};
+    param.sched_priority = priority;
+    int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0) {
+        LOG_WARNING(std::string("SCHED_FIFO refused (") + std::strerror(error) +
+                    "), emulation thread stays SCHED_OTHER - needs CAP_SYS_NICE or an RLIMIT_RTPRIO of " + std::to_string(priority));
+        return false;
+    }
+    LOG_INFO("Emulation thread running SCHED_FIFO at priority " + std::to_string(priority));
+#elif defined(_WIN32)
+    // Closest Windows equivalent that does not need the realtime priority class
+    if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        LOG_WARNING("Could not raise the emulation thread to time-critical priority");
+        return false;
+    }
+    LOG_INFO("Emulation thread running at time-critical priority");
+#else
+    (void)priority;
+    LOG_WARNING("Real-time scheduling is not supported on this platform");
+    return false;
+#endif
+    return true;
+}
+}
+
+ThreadPlacementConfig loadThreadPlacementConfig(const std::string& path) {
+    ThreadPlacementConfig config;
+    readConfigFile(path, [&config](const std::string& key, const std::string& value, const std::string& where) {
+        if (key == "emulation" || key == "render" || key == "worker") {
+            std::vector<int>& cpus = key == "emulation" ? config.emulationCpus
+                                   : key == "render" ? config.renderCpus : config.workerCpus;
+            if (!parseCpuList(value, cpus)) {
+                LOG_WARNING(where + "expected a CPU list such as '0,2-3'");
+            }
+        } else if (key == "realtime") {
+            if (value == "on") {
+                config.realtime = true;
+            } else if (value == "off") {
+                config.realtime = false;
+            } else {
+                int priority = 0;
+                try {
+                    priority = std::stoi(value);
+                } catch (const std::exception&) {
+                }
+                if (priority < 1 || priority > 99) {
+                    LOG_WARNING(where + "expected on, off or a priority 1-99");
+                    return true;
+                }
+                config.realtime = true;
+                config.realtimePriority = priority;
+            }
+        } else if (key == "mlock") {
+            if (value != "on" && value != "off") {
+                LOG_WARNING(where + "expected on or off");
+                return true;
+            }
+            config.lockMemory = value == "on";
+        } else if (key == "ppu_thread") {
+            if (value == "on") {
+                config.ppuThread = PPUThreadMode::ON;
+            } else if (value == "off") {
+                config.ppuThread = PPUThreadMode::OFF;
+            } else if (value == "auto") {
+                config.ppuThread = PPUThreadMode::AUTO;
+            } else {
+                LOG_WARNING(where + "expected on, off or auto");
+            }
+        } else {
+            LOG_WARNING(where + "unknown setting '" + key + "'");
+        }
+        return true;
+    });
+    return config;
+}
+
+// The worker only pays off with a core of its own. The core count alone is
+// no evidence of a free one, so AUTO wants a configured worker CPU set.
+// Check the host with --bench-uncapped before relying on it.
+bool usePPUThread(const ThreadPlacementConfig& config) {
+    switch (config.ppuThread) {
+        case PPUThreadMode::ON:  return true;
+        case PPUThreadMode::OFF: return false;
+        case PPUThreadMode::AUTO: break;
+    }
+    return !config.workerCpus.empty();
+}
+
+bool placeCurrentThread(const ThreadPlacementConfig& config, ThreadRole role) {
+    const std::vector<int>& cpus = role == ThreadRole::EMULATION ? config.emulationCpus
+                                 : role == ThreadRole::RENDER ? config.renderCpus : config.workerCpus;
+    bool ok = true;
+    if (!cpus.empty()) {
+        ok = pinCurrentThread(cpus, roleName(role));
+    }
+    if (role == ThreadRole::EMULATION && config.realtime) {
+        ok = makeCurrentThreadRealtime(config.realtimePriority) && ok;
+    }
+    return ok;
+}
+
+bool lockProcessMemory() {
+#if defined(__linux__)
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        LOG_INFO("Locked process memory (current and future mappings)");
+        return true;
+    }
+    int error = errno;
+    if (mlockall(MCL_CURRENT) == 0) {
+        LOG_WARNING(std::string("mlockall(MCL_FUTURE) refused (") + std::strerror(error) +
+                    "), locked current mappings only");
+        return true;
+    }
+    LOG_WARNING(std::string("mlockall refused (") + std::strerror(errno) +
+                "), memory stays pageable - raise RLIMIT_MEMLOCK or grant CAP_IPC_LOCK");
+    return false;
+#else
+    LOG_WARNING("Memory locking is not supported on this platform");
+    return false;
+#endif
+}
+
+void unlockProcessMemory() {
+#if defined(__linux__)
+    munlockall();
+#endif
+}
+
+ThreadSchedMonitor::ThreadSchedMonitor()
+    : m_Start{false, 0, 0, 0}
+    , m_StartNs(0)
+    , m_Report{false, 0.0, 0.0, 0.0}
+{
+}
+
+ThreadSchedMonitor::Counters ThreadSchedMonitor::readCounters() {
+    Counters counters{false, 0, 0, 0};
+#if defined(__linux__)
+    rusage usage{};
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) {
+        return counters;
+    }
+    counters.valid = true;
+    counters.voluntary = static_cast<uint64_t>(usage.ru_nvcsw);
+    counters.involuntary = static_cast<uint64_t>(usage.ru_nivcsw);
+
+    // Only exposed with CONFIG_SCHED_DEBUG; reported as 0 without it
+    std::ifstream sched("/proc/thread-self/sched");
+    std::string line;
+    while (std::getline(sched, line)) {
+        if (line.compare(0, 16, "se.nr_migrations") == 0) {
+            // strtoull: this runs on the emulation thread, so odd text must not throw
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                const char* text = line.c_str() + colon + 1;
+                char* end = nullptr;
+                errno = 0;
+                unsigned long long value = std::strtoull(text, &end, 10);
+                if (end != text && errno == 0) {
+                    counters.migrations = value;
+                }
+            }
+            break;
+        }
+    }
+#endif
+    return counters;
+}
+
+void ThreadSchedMonitor::restart() {
+    m_Start = readCounters();
+    m_StartNs = nowNs();
+}
+
+bool ThreadSchedMonitor::sample() {
+    int64_t now = nowNs();
+    if (now - m_StartNs < NS_PER_MINUTE) {
+        return false;
+    }
+    Counters counters = readCounters();
+    ThreadSchedReport report{false, 0.0, 0.0, 0.0};
+    if (counters.valid && m_Start.valid) {
+        double minutes = static_cast<double>(now - m_StartNs) / NS_PER_MINUTE;
+        report.available = true;
+        report.involuntarySwitchesPerMin = (counters.involuntary - m_Start.involuntary) / minutes;
+        report.contextSwitchesPerMin = (counters.voluntary - m_Start.voluntary) / minutes + report.involuntarySwitchesPerMin;
+        report.migrationsPerMin = (counters.migrations - m_Start.migrations) / minutes;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_ReportMutex);
+        m_Report = report;
+    }
+    m_Start = counters;
+    m_StartNs = now;
+    return true;
+}
+
+ThreadSchedReport ThreadSchedMonitor::report() const {
+    std::lock_guard<std::mutex> lock(m_ReportMutex);
+    return m_Report;
+}
@@ -0,0 +1,19 @@
+#include <tile_cache.h>
+
+TileCache::TileCache(ByteSpan vram)
+    : m_VRAM(vram.data())
+    , m_Kernels(pixelKernels())
+{
+    invalidateAll();
+}
+
+void TileCache::invalidateAll() {
+    for (bool& dirty : m_Dirty) {
+        dirty = true;
+    }
+}
+
+void TileCache::decode(int tile) {
+    m_Kernels.decodeRows(m_VRAM + tile * TILE_SIZE, TILE_HEIGHT, m_Tiles[tile][0]);
+    m_Dirty[tile] = false;
+}
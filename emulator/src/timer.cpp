@@ -19,94 +19,102 @@ const int CPU_CLOCK_SPEED = 4194304; // Hz (T-cycles per second)
 
 Timer::Timer(std::shared_ptr<MemoryController> memory)
     : memoryController(memory),
-      m_Counter(0),          // TIMA (0xFF05)
-      m_Modulo(0),           // TMA (0xFF06)
-      m_Control(0),          // TAC (0xFF07)
-      m_IsEnabled(false),
-      m_TimerCounter(0),     // Internal counter for TIMA increments
-      m_DividerCounter(0),   // Internal counter for DIV increments
-      m_DividerRegister(0)   // DIV (0xFF04) - Actual register value
+      m_Scheduler(memory->scheduler()),
+      m_State(memory->state().timer),
+      m_Modulo(memory->state().ioRegister(TMA)),
+      m_Control(memory->state().ioRegister(TMC))
 {
-    // Reset internal counters based on initial TAC state (usually 0)
-    setClockFreq(); // Initialize m_TimerCounter based on TAC=0
+    m_Scheduler.setHandler(SchedulerEvent::TIMA_OVERFLOW, [this](uint64_t deadline) { onOverflow(deadline); });
+    // DIV counts from power on; TIMA only once TAC enables it
+    m_State.divBase = m_Scheduler.now();
+    m_State.timaBase = m_Scheduler.now();
+    m_State.timaValue = 0;
     LOG_INFO("Timer initialized");
 }
 
+Timer::~Timer() {
+    m_Scheduler.cancel(SchedulerEvent::TIMA_OVERFLOW);
+    m_Scheduler.setHandler(SchedulerEvent::TIMA_OVERFLOW, nullptr);
+}
+
 bool Timer::isEnabled() const {
-    // Read TAC register directly to get the most up-to-date enable status
-    return (memoryController->read(TMC) & TIMER_ENABLE_BIT) != 0;
-}
-
-// Updates the DIV register (0xFF04) based on T-cycles passed
-void Timer::updateDividerRegister(int cycles) {
-    LOG_DEBUG("Updating divider register with cycles: " + std::to_string(cycles));
-    m_DividerCounter += cycles; // Accumulate T-cycles
-    LOG_DEBUG("Divider Counter after increment: " + std::to_string(m_DividerCounter));
-    // DIV increments every 256 T-cycles (16384 Hz)
-    while (m_DividerCounter >= 256) {
-        LOG_DEBUG("Divider Counter before decrement: " + std::to_string(m_DividerCounter));
-        m_DividerCounter -= 256;
-        m_DividerRegister++; // Let it wrap around naturally (BYTE)
-        LOG_DEBUG("Divider Register incremented: " + std::to_string(m_DividerRegister));
-        // LOG_DEBUG("Divider Register incremented to: " + std::to_string(m_DividerRegister)); // Can be noisy
+    // TAC lives in the shared IO page, so this sees bus writes as well
+    return (m_Control & TIMER_ENABLE_BIT) != 0;
+}
+
+// DIV and TIMA both hang off one internal counter that restarts on a DIV write
+uint64_t Timer::systemCounter() const {
+    return m_Scheduler.now() - m_State.divBase;
+}
+
+// TIMA increments each time the system counter reaches a multiple of the
+// selected period (the falling edge of the selected counter bit)
+BYTE Timer::currentTIMA() const {
+    if (!isEnabled()) {
+        return m_State.timaValue;
+    }
+    uint64_t period = getFrequencyPeriod();
+    uint64_t increments = systemCounter() / period - (m_State.timaBase - m_State.divBase) / period;
+    uint64_t value = m_State.timaValue + increments;
+    if (value > BYTE_MASK) {
+        // Overflowed inside the current instruction; the event has not run yet
+        return static_cast<BYTE>(m_Modulo + (value - 0x100));
     }
+    return static_cast<BYTE>(value);
 }
 
-// Resets the DIV register (0xFF04) when written to
-void Timer::resetDividerRegister() {
-    m_DividerRegister = 0;
-    m_DividerCounter = 0; // Also reset the internal counter
-    LOG_DEBUG("Divider Register reset to 0 by write");
+void Timer::materializeTIMA() {
+    m_State.timaValue = currentTIMA();
+    m_State.timaBase = m_Scheduler.now();
 }
 
-// Main update function called with T-cycles from CPU execution
-void Timer::update(int cycles) {
-        // Update divider register unconditionally
-    LOG_DEBUG("Timer update called with cycles: " + std::to_string(cycles));
-    updateDividerRegister(cycles);
+void Timer::incrementTIMA() {
+    if (++m_State.timaValue == 0) {
+        m_State.timaValue = m_Modulo;
+        memoryController->RequestInterrupt(TIMER_INTERRUPT_BIT);
+    }
+}
 
-    // Check if timer is enabled via TAC register
+// Schedules the single future event that matters: the next TIMA overflow
+void Timer::scheduleOverflow() {
     if (!isEnabled()) {
-        LOG_DEBUG("Timer is disabled, skipping update.");
+        m_Scheduler.cancel(SchedulerEvent::TIMA_OVERFLOW);
         return;
     }
+    uint64_t period = getFrequencyPeriod();
+    uint64_t edgesSoFar = (m_State.timaBase - m_State.divBase) / period;
+    uint64_t incrementsLeft = 0x100 - m_State.timaValue;
+    m_Scheduler.scheduleAt(SchedulerEvent::TIMA_OVERFLOW, m_State.divBase + (edgesSoFar + incrementsLeft) * period);
+}
 
-    // Decrement the counter towards the next TIMA increment
-    m_TimerCounter -= cycles;
-    LOG_DEBUG("Timer Counter after decrement: " + std::to_string(m_TimerCounter));
-    // Check if enough cycles have passed for a TIMA increment
-    while (m_TimerCounter <= 0) {
-        LOG_DEBUG("Timer Counter reached 0, incrementing TIMA.");
-        // Reload the counter with the period for the current frequency
-        m_TimerCounter += getFrequencyPeriod(); // Add the period back
-        
-        LOG_DEBUG("Timer Counter after incremnt from getFrequencyPeriod : " + std::to_string(m_TimerCounter));
-        // Increment TIMA (0xFF05)
-        m_Counter++;
-
-        // Check for TIMA overflow
-        if (m_Counter == 0) { // Overflow occurred (0xFF -> 0x00)
-            // Reload TIMA with TMA (0xFF06)
-            LOG_DEBUG("Timer overflow - Reloading TIMA with TMA: " + std::to_string(m_Modulo));
-            m_Counter = m_Modulo;
-
-            // Request Timer Interrupt (Set bit 2 in IF register 0xFF0F)
-            memoryController->write(IF_REGISTER,
-                memoryController->read(IF_REGISTER) | TIMER_INTERRUPT_BIT);
-            LOG_DEBUG("Timer Interrupt Requested (IF bit 2 set)"); // *** ADD THIS LOG ***
-
-            LOG_DEBUG("Timer overflow - Interrupt requested. TIMA reloaded with TMA=" + std::to_string(m_Modulo));
-        }
-    }
+void Timer::onOverflow(uint64_t deadline) {
+    // Reload TIMA with TMA (0xFF06) and request the timer interrupt
+    m_State.timaValue = m_Modulo;
+    m_State.timaBase = deadline;
+    memoryController->RequestInterrupt(TIMER_INTERRUPT_BIT);
+    LOG_DEBUG("Timer overflow - Interrupt requested. TIMA reloaded with TMA=" + std::to_string(m_Modulo));
+    scheduleOverflow();
 }
 
+// Resets the DIV register (0xFF04) when written to
+void Timer::resetDividerRegister() {
+    materializeTIMA();
+    // Resetting the counter while the selected bit is high is a falling edge
+    if (isEnabled() && (systemCounter() & (getFrequencyPeriod() / 2))) {
+        incrementTIMA();
+    }
+    m_State.divBase = m_Scheduler.now();
+    m_State.timaBase = m_State.divBase;
+    scheduleOverflow();
+    LOG_DEBUG("Divider Register reset to 0 by write");
+}
 
 BYTE Timer::read(WORD address) const {
     switch (address) {
-        case TIMA: return m_Counter;
+        case TIMA: return currentTIMA();
         case TMA:  return m_Modulo;
         case TMC:  return m_Control; // Return the internally tracked control value
-        case DIV_REGISTER: return m_DividerRegister; // Divider register read
+        case DIV_REGISTER: return getDividerRegister(); // Divider register read
         default:
             LOG_WARNING("Attempted to read from invalid timer address: 0x" +
                         std::to_string(address));
@@ -117,26 +125,37 @@ BYTE Timer::read(WORD address) const {
 void Timer::write(WORD address, BYTE value) {
     switch (address) {
         case TIMA:
-            m_Counter = value;
-            // LOG_DEBUG("TIMA (0xFF05) written with value: " + std::to_string(value));
+            m_State.timaValue = value;
+            m_State.timaBase = m_Scheduler.now();
+            scheduleOverflow();
             break;
         case TMA:
-            m_Modulo = value;
-            // LOG_DEBUG("TMA (0xFF06) written with value: " + std::to_string(value));
+            m_Modulo = value;  // Only used at the next reload
             break;
         case DIV_REGISTER:
             resetDividerRegister();  // Any write resets the register and internal counter
             break;
         case TMC:
             {
+                BYTE previous = m_Control;
+                if (previous != value) {
+                    // Bring TIMA up to date under the old configuration first
+                    materializeTIMA();
+                    // Disabling or switching away from a high counter bit is a falling edge
+                    uint64_t counter = systemCounter();
+                    bool oldBit = (previous & TIMER_ENABLE_BIT) && (counter & (getFrequencyPeriod(previous) / 2));
+                    bool newBit = (value & TIMER_ENABLE_BIT) && (counter & (getFrequencyPeriod(value) / 2));
+                    if (oldBit && !newBit) {
+                        incrementTIMA();
+                    }
+                }
                 // Store the new control value internally
                 m_Control = value;
-                // Update the enabled state based on the new value
-                m_IsEnabled = (value & TIMER_ENABLE_BIT) != 0;
-                // Update the internal frequency counter immediately
-                setClockFreq();
+                if (previous != value) {
+                    setClockFreq();
+                }
                 LOG_DEBUG("Timer Control (TMC/0xFF07) written: 0x" + std::to_string(value) +
-                          ", Enabled: " + (m_IsEnabled ? "Yes" : "No") +
+                          ", Enabled: " + (isEnabled() ? "Yes" : "No") +
                           ", Freq: " + std::to_string(getFrequency()) + " Hz");
             }
             break;
@@ -164,21 +183,19 @@ void Timer::resetInterruptRequest()
 
 void Timer::reset() {
     // Reset all timer registers to their initial values
-    m_Counter = 0;         // Reset TIMA
     m_Modulo = 0;          // Reset TMA
-    m_Control = 0;         // Reset TMC
-    m_TimerCounter = 0;    // Reset internal counter
-    m_IsEnabled = false;   // Disable timer
-    m_DividerCounter = 0;  // Reset divider counter
-    m_DividerRegister = 0; // Reset divider register
+    m_Control = 0;         // Reset TMC (disables the timer)
+    m_State.divBase = m_Scheduler.now();   // Reset divider register
+    m_State.timaBase = m_State.divBase;
+    m_State.timaValue = 0; // Reset TIMA
+    m_Scheduler.cancel(SchedulerEvent::TIMA_OVERFLOW);
     
     LOG_DEBUG("Timer reset to initial state");
 }
-// Sets the internal timer counter reload value based on TAC frequency bits
+// Re-bases TIMA and reschedules (or cancels) the overflow for the new TAC value
 void Timer::setClockFreq() {
-    // We don't reset m_TimerCounter here, just calculate the period for the *next* reload
-    // The current countdown continues until it hits <= 0.
-    // The getFrequencyPeriod() function will return the correct value based on m_Control.
+    m_State.timaBase = m_Scheduler.now();
+    scheduleOverflow();
 }
 
 // Returns the frequency in Hz based on TAC bits
@@ -194,7 +211,11 @@ int Timer::getFrequency() const {
 
 // Returns the number of T-cycles per TIMA increment for the current frequency
 int Timer::getFrequencyPeriod() const {
-     switch (m_Control & CLOCK_SELECT_MASK) {
+    return getFrequencyPeriod(m_Control);
+}
+
+int Timer::getFrequencyPeriod(BYTE control) {
+     switch (control & CLOCK_SELECT_MASK) {
         case 0: return 1024; // CPU_CLOCK_SPEED / 4096
         case 1: return 16;   // CPU_CLOCK_SPEED / 262144
         case 2: return 64;   // CPU_CLOCK_SPEED / 65536
@@ -205,7 +226,7 @@ int Timer::getFrequencyPeriod() const {
 
 // Returns the current value of the DIV register
 BYTE Timer::getDividerRegister() const {
-    return m_DividerRegister;
+    return static_cast<BYTE>(systemCounter() / DIV_TICK_CYCLES);
 }
 
 
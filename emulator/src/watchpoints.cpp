@@ -0,0 +1,120 @@
+#include <watchpoints.h>
+#include <logger.h>
+#include <iomanip>
+#include <sstream>
+
+Watchpoints::Watchpoints()
+    : m_HasWatchpoints(false)
+    , m_InstrumentAll(false)
+    , m_NextId(1)
+    , m_Hit{}
+    , m_HitPending(false)
+{
+    for (auto& flags : m_PageFlags) {
+        flags.store(0, std::memory_order_relaxed);
+    }
+}
+
+int Watchpoints::add(WORD start, WORD end, BYTE types) {
+    types &= (WATCH_READ | WATCH_WRITE | WATCH_EXECUTE);
+    if (types == 0 || end < start) {
+        LOG_WARNING("Invalid watchpoint range or type");
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int id = m_NextId++;
+    m_Watchpoints.push_back({id, start, end, types});
+    rebuildPageFlags();
+    std::stringstream ss;
+    ss << "Watchpoint " << id << " set on 0x" << std::hex << std::uppercase << std::setfill('0')
+       << std::setw(4) << start << "-0x" << std::setw(4) << end;
+    LOG_INFO(ss.str());
+    return id;
+}
+
+bool Watchpoints::remove(int id) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto it = m_Watchpoints.begin(); it != m_Watchpoints.end(); ++it) {
+        if (it->id == id) {
+            m_Watchpoints.erase(it);
+            rebuildPageFlags();
+            return true;
+        }
+    }
+    LOG_WARNING("No watchpoint with id " + std::to_string(id));
+    return false;
+}
+
+void Watchpoints::clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Watchpoints.clear();
+    rebuildPageFlags();
+    m_HitPending.store(false, std::memory_order_release);
+}
+
+std::vector<Watchpoint> Watchpoints::list() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Watchpoints;
+}
+
+void Watchpoints::setInstrumentAll(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_InstrumentAll = enabled;
+    rebuildPageFlags();
+}
+
+void Watchpoints::rebuildPageFlags() {
+    std::array<BYTE, WATCH_PAGE_COUNT> flags{};
+    if (m_InstrumentAll) {
+        flags.fill(WATCH_READ | WATCH_WRITE | WATCH_EXECUTE);
+    }
+    for (const Watchpoint& wp : m_Watchpoints) {
+        for (int page = wp.start >> WATCH_PAGE_SHIFT; page <= (wp.end >> WATCH_PAGE_SHIFT); ++page) {
+            flags[page] |= wp.types;
+        }
+    }
+    for (int page = 0; page < WATCH_PAGE_COUNT; ++page) {
+        m_PageFlags[page].store(flags[page], std::memory_order_relaxed);
+    }
+    m_HasWatchpoints.store(!m_Watchpoints.empty(), std::memory_order_relaxed);
+}
+
+bool Watchpoints::check(WORD address, BYTE type, WORD pc, BYTE oldValue, BYTE newValue) {
+    if (!m_HasWatchpoints.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const Watchpoint& wp : m_Watchpoints) {
+        if ((wp.types & type) && address >= wp.start && address <= wp.end) {
+            // Keep the first hit of an instruction (e.g. PUSH writes two bytes)
+            if (!m_HitPending.load(std::memory_order_relaxed)) {
+                m_Hit = {wp.id, type, address, pc, oldValue, newValue};
+                m_HitPending.store(true, std::memory_order_release);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+WatchHit Watchpoints::takeHit() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_HitPending.store(false, std::memory_order_release);
+    return m_Hit;
+}
+
+std::string Watchpoints::describe(const WatchHit& hit) {
+    const char* kind = hit.type == WATCH_WRITE ? "write" : (hit.type == WATCH_READ ? "read" : "execute");
+    std::stringstream ss;
+    ss << std::hex << std::uppercase << std::setfill('0');
+    ss << "Watchpoint " << std::dec << hit.id << std::hex << " (" << kind << ") hit at 0x"
+       << std::setw(4) << hit.address << ", PC=0x" << std::setw(4) << hit.pc;
+    if (hit.type == WATCH_WRITE) {
+        ss << ", old=0x" << std::setw(2) << static_cast<int>(hit.oldValue)
+           << ", new=0x" << std::setw(2) << static_cast<int>(hit.newValue);
+    } else {
+        ss << ", value=0x" << std::setw(2) << static_cast<int>(hit.newValue);
+    }
+    return ss.str();
+}
@@ -1,15 +1,145 @@
 #include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
 #include <emulator.h>
 #include <logger.h>
+#include <pixel_kernels.h>
+#include <thread_placement.h>
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
+const std::string DEFAULT_GAME_PATH = "roms\\Tetris.gb"; // Change this to your ROM path
+
+// --replay <input log> [--rom <path>] [--frames <n>] [--ppu-thread on|off]
+// Runs the ROM deterministically with the logged inputs and prints
+// "state <hash> cycle <cycle>". The same ROM and log must always print the
+// same line, whatever the host and the PPU thread setting.
+int replayInputLog(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: --replay <input log> [--rom <path>] [--frames <n>] [--ppu-thread on|off]" << std::endl;
+        return 1;
+    }
+    std::string inputLog = argv[2];
+    std::string gamePath = DEFAULT_GAME_PATH;
+    int frames = 600;
+    std::string ppuThread;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--rom") {
+            gamePath = argv[i + 1];
+        } else if (option == "--frames") {
+            frames = std::atoi(argv[i + 1]);
+        } else if (option == "--ppu-thread") {
+            ppuThread = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    Logger::getInstance()->setLogLevel(LogLevel::WARNING);
+    Emulator emulator;
+    if (!emulator.init(true)) {  // Headless: runs without a display, e.g. in CI
+        return 1;
+    }
+    ThreadPlacementConfig placement = loadThreadPlacementConfig(THREAD_CONFIG_FILE);
+    if (ppuThread == "on" || ppuThread == "off") {
+        placement.ppuThread = ppuThread == "on" ? PPUThreadMode::ON : PPUThreadMode::OFF;
+    }
+    emulator.setThreadPlacement(placement);
+    if (!emulator.loadGame(gamePath) || !emulator.loadInputLog(inputLog)) {
+        emulator.cleanup();
+        return 1;
+    }
+    emulator.setDeterministic(true);
+    for (int frame = 0; frame < frames; frame++) {
+        if (!emulator.stepFrame()) {
+            emulator.cleanup();
+            return 1;
+        }
+    }
+    std::printf("state %016llx cycle %llu\n", static_cast<unsigned long long>(emulator.getStateHash()),
+                static_cast<unsigned long long>(emulator.getCycle()));
+    emulator.cleanup();
+    return 0;
+}
+
+// --bench-uncapped <rom> [--frames <n>]
+// End-to-end throughput with no frame pacing: runs the ROM headless through
+// stepFrame with the PPU worker off, then on, and prints frames/s for each.
+// The worker uses the threads.cfg CPU sets. PPUThreadMode::AUTO should
+// follow what this reports on the target host, not the PPU-only --bench-ppu.
+int benchmarkUncapped(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: --bench-uncapped <rom> [--frames <n>]" << std::endl;
+        return 1;
+    }
+    std::string gamePath = argv[2];
+    int frames = 600;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--frames") {
+            frames = std::atoi(argv[i + 1]);
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    const int warmupFrames = 30;
+
+    Logger::getInstance()->setLogLevel(LogLevel::WARNING);
+    std::printf("%u hardware threads, %d frames\n", std::thread::hardware_concurrency(), frames);
+    for (PPUThreadMode mode : { PPUThreadMode::OFF, PPUThreadMode::ON }) {
+        Emulator emulator;
+        if (!emulator.init(true)) {
+            return 1;
+        }
+        ThreadPlacementConfig placement = loadThreadPlacementConfig(THREAD_CONFIG_FILE);
+        placement.ppuThread = mode;
+        emulator.setThreadPlacement(placement);
+        if (!emulator.loadGame(gamePath)) {
+            emulator.cleanup();
+            return 1;
+        }
+        for (int frame = 0; frame < warmupFrames; frame++) {
+            emulator.stepFrame();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            emulator.stepFrame();
+        }
+        emulator.getStateHash();  // Waits for the worker's last frame
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("ppu worker %-3s %8.1f frames/s %8.1f us/frame\n", mode == PPUThreadMode::ON ? "on:" : "off:",
+                    frames / elapsed.count(), elapsed.count() * 1000000.0 / frames);
+        emulator.cleanup();
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     bool debugMode = false;
     
     auto logger = Logger::getInstance();
     logger->setLogLevel(LogLevel::INFO);
+    if (argc > 1 && std::string(argv[1]) == "--bench-pixels") {
+        // ns per scanline of each pixel kernel version the host supports
+        benchmarkPixelKernels();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-ppu") {
+        // Frame cost of the scanline and pixel-FIFO engines, inline and on the PPU worker
+        benchmarkPPUEngines();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-uncapped") {
+        return benchmarkUncapped(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--replay") {
+        return replayInputLog(argc, argv);
+    }
     if (argc > 1) {
         debugMode = true;
     }
@@ -29,7 +159,7 @@ int main(int argc, char* argv[]) {
     }
 
     // Try to load ROM
-    std::string gamePath = "roms\\Tetris.gb"; // Change this to your ROM path
+    std::string gamePath = DEFAULT_GAME_PATH;
     
 
     LOG_INFO("Loading ROM: " + gamePath);